@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+
+#include <dpp_utils/command_registry.h>
+#include <dpp_utils/rate_limiter.h>
+
+namespace {
+
+void bench_handler(const dpp::slashcommand_t &event, std::string name,
+                   int64_t count, std::optional<bool> flag) {
+    benchmark::DoNotOptimize(name);
+    benchmark::DoNotOptimize(count);
+    benchmark::DoNotOptimize(flag);
+}
+
+dpp::slashcommand_t make_event() {
+    dpp::command_interaction interaction;
+    interaction.name = "bench";
+
+    dpp::command_data_option name_option;
+    name_option.name = "name";
+    name_option.type = dpp::co_string;
+    name_option.value = std::string{"Instellate"};
+    interaction.options.emplace_back(name_option);
+
+    dpp::command_data_option count_option;
+    count_option.name = "count";
+    count_option.type = dpp::co_integer;
+    count_option.value = int64_t{42};
+    interaction.options.emplace_back(count_option);
+
+    dpp::slashcommand_t event;
+    event.command.data = interaction;
+    return event;
+}
+
+void BM_command_executor_bind(benchmark::State &state) {
+    dpp_utils::internal::command_executor<decltype(bench_handler)> executor{
+        bench_handler, {"name", "count", "flag"}};
+    const dpp::slashcommand_t event = make_event();
+
+    for (auto _ : state) {
+        executor.execute_command(event);
+    }
+}
+BENCHMARK(BM_command_executor_bind);
+
+void BM_command_registry_dispatch(benchmark::State &state) {
+    dpp_utils::command_registry registry;
+    registry.add_command("bench", "Benchmark command", bench_handler,
+                         {"name", "count", "flag"});
+
+    if (state.range(0) != 0) {
+        registry.set_profiler(std::make_shared<dpp_utils::command_profiler>());
+    }
+
+    const dpp::slashcommand_t event = make_event();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(registry.execute_command(event));
+    }
+}
+BENCHMARK(BM_command_registry_dispatch)->ArgName("profiled")->Arg(0)->Arg(1);
+
+void BM_rate_limiter_acquire(benchmark::State &state) {
+    // Shared between the benchmark threads to measure shard contention
+    static dpp_utils::rate_limiter limiter{{1e9, 1e9}};
+
+    uint64_t user_id = static_cast<uint64_t>(state.thread_index());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(limiter.try_acquire(user_id, 1, "bench"));
+        user_id = (user_id + 7919) % 1000000;
+    }
+}
+BENCHMARK(BM_rate_limiter_acquire)->Threads(1)->Threads(8);
+
+} // namespace
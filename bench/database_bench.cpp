@@ -0,0 +1,207 @@
+#include "fake_pg_server.h"
+
+#include <benchmark/benchmark.h>
+
+#include <dpp/cluster.h>
+#include <dpp_utils/database.h>
+
+#include <postgresql/server/catalog/pg_type_d.h>
+
+#include <cstdlib>
+#include <memory>
+
+namespace {
+
+dpp_utils::result make_result(const int rows) {
+    PGresult *res = PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK);
+
+    PGresAttDesc attrs[3]{};
+    attrs[0].name = const_cast<char *>("id");
+    attrs[0].typid = INT8OID;
+    attrs[1].name = const_cast<char *>("name");
+    attrs[1].typid = TEXTOID;
+    attrs[2].name = const_cast<char *>("score");
+    attrs[2].typid = FLOAT8OID;
+    for (auto &attr : attrs) {
+        attr.typlen = -1;
+        attr.atttypmod = -1;
+    }
+    PQsetResultAttrs(res, 3, attrs);
+
+    for (int i = 0; i < rows; ++i) {
+        std::string id = std::to_string(565197576026980365 + i);
+        std::string name = "user_" + std::to_string(i);
+        std::string score = std::to_string(i * 0.5);
+
+        PQsetvalue(res, i, 0, id.data(), static_cast<int>(id.size()));
+        PQsetvalue(res, i, 1, name.data(), static_cast<int>(name.size()));
+        PQsetvalue(res, i, 2, score.data(), static_cast<int>(score.size()));
+    }
+
+    return dpp_utils::result{res};
+}
+
+void BM_row_get_index(benchmark::State &state) {
+    dpp_utils::result res = make_result(1);
+    dpp_utils::row row = res[0];
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(row.get<int64_t>(0));
+        benchmark::DoNotOptimize(row.get<std::string>(1));
+        benchmark::DoNotOptimize(row.get<double>(2));
+    }
+}
+BENCHMARK(BM_row_get_index);
+
+void BM_row_get_name(benchmark::State &state) {
+    dpp_utils::result res = make_result(1);
+    dpp_utils::row row = res[0];
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(row.get<int64_t>("id"));
+        benchmark::DoNotOptimize(row.get<std::string>("name"));
+        benchmark::DoNotOptimize(row.get<double>("score"));
+    }
+}
+BENCHMARK(BM_row_get_name);
+
+void BM_result_iterate(benchmark::State &state) {
+    dpp_utils::result res = make_result(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const dpp_utils::row &row : res) {
+            sum += row.get<int64_t>(0);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_result_iterate)->Arg(1000)->Arg(100000);
+
+void BM_result_column(benchmark::State &state) {
+    dpp_utils::result res = make_result(static_cast<int>(state.range(0)));
+
+    for (auto _ : state) {
+        auto ids = res.column<int64_t>(0);
+
+        int64_t sum = 0;
+        for (const int64_t id : ids.values) {
+            sum += id;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_result_column)->Arg(1000)->Arg(100000);
+
+void BM_result_columns(benchmark::State &state) {
+    dpp_utils::result res = make_result(static_cast<int>(state.range(0)));
+    const bool parallel = state.range(1) != 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            res.columns<int64_t, std::string, double>(parallel));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 3);
+}
+BENCHMARK(BM_result_columns)
+    ->ArgNames({"rows", "parallel"})
+    ->Args({100000, 0})
+    ->Args({100000, 1})
+    ->UseRealTime();
+
+void BM_get_param_strings(benchmark::State &state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dpp_utils::database::get_param_strings(
+            int64_t{565197576026980365}, std::string{"Instellate"},
+            std::optional<int32_t>{}, true, 0.5));
+    }
+}
+BENCHMARK(BM_get_param_strings);
+
+constexpr const char *query_stmnt = "SELECT id, name FROM users WHERE id = $1";
+
+/**
+ * Database used by the end to end benchmarks. DPP_UTILS_BENCH_PG can point
+ * at a real Postgres loaded with test/schema.sql, otherwise a scripted fake
+ * server is started.
+ */
+struct database_environment {
+    std::unique_ptr<dpp_utils::bench::fake_pg_server> server;
+    dpp::cluster cluster;
+    std::unique_ptr<dpp_utils::database> db;
+
+    database_environment() {
+        std::string connection_string;
+        if (const char *env = std::getenv("DPP_UTILS_BENCH_PG")) {
+            connection_string = env;
+        } else {
+            server = std::make_unique<dpp_utils::bench::fake_pg_server>(
+                std::vector<dpp_utils::bench::fake_pg_server::column>{
+                    {"id", INT8OID}, {"name", TEXTOID}},
+                std::vector<std::vector<std::string>>{
+                    {"565197576026980365", "Instellate"}});
+            server->start();
+            connection_string = server->connection_string();
+        }
+
+        db = std::make_unique<dpp_utils::database>(connection_string.c_str());
+        db->start(cluster);
+    }
+
+    static database_environment &get() {
+        static database_environment env;
+        return env;
+    }
+
+    void run_until(const bool &done) {
+        while (!done) {
+            cluster.socketengine->process_events();
+        }
+    }
+};
+
+void BM_database_query(benchmark::State &state) {
+    auto &env = database_environment::get();
+
+    for (auto _ : state) {
+        bool done = false;
+        env.db->query(
+            query_stmnt,
+            [&done](const dpp_utils::result &res) {
+                benchmark::DoNotOptimize(res[0].get<int64_t>(0));
+                done = true;
+            },
+            int64_t{565197576026980365});
+
+        env.run_until(done);
+    }
+}
+BENCHMARK(BM_database_query)->UseRealTime();
+
+#ifdef DPP_CORO
+dpp::task<void> run_co_query(dpp_utils::database *db, bool *done) {
+    dpp_utils::result res =
+        co_await db->co_query(query_stmnt, int64_t{565197576026980365});
+    benchmark::DoNotOptimize(res[0].get<int64_t>(0));
+    *done = true;
+}
+
+void BM_database_co_query(benchmark::State &state) {
+    auto &env = database_environment::get();
+
+    for (auto _ : state) {
+        bool done = false;
+        dpp::task<void> task = run_co_query(env.db.get(), &done);
+
+        env.run_until(done);
+    }
+}
+BENCHMARK(BM_database_co_query)->UseRealTime();
+#endif
+
+} // namespace
@@ -0,0 +1,297 @@
+#include "fake_pg_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+
+// Request codes sent instead of a protocol version before the startup packet
+#define SSL_REQUEST_CODE 80877103
+#define GSSENC_REQUEST_CODE 80877104
+
+namespace {
+
+class message {
+    std::string _buffer;
+
+  public:
+    explicit message(const char type) {
+        _buffer += type;
+        _buffer.append(4, '\0');
+    }
+
+    message &int16(const int16_t val) {
+        const uint16_t net = htons(static_cast<uint16_t>(val));
+        _buffer.append(reinterpret_cast<const char *>(&net), sizeof(net));
+        return *this;
+    }
+
+    message &int32(const int32_t val) {
+        const uint32_t net = htonl(static_cast<uint32_t>(val));
+        _buffer.append(reinterpret_cast<const char *>(&net), sizeof(net));
+        return *this;
+    }
+
+    message &str(const std::string &val) {
+        _buffer.append(val);
+        _buffer += '\0';
+        return *this;
+    }
+
+    message &bytes(const std::string &val) {
+        _buffer.append(val);
+        return *this;
+    }
+
+    // Writes the length, which excludes the type byte
+    void append_to(std::string &out) {
+        const uint32_t len =
+            htonl(static_cast<uint32_t>(_buffer.size() - 1));
+        std::memcpy(_buffer.data() + 1, &len, sizeof(len));
+        out += _buffer;
+    }
+};
+
+bool read_exact(const int fd, char *buf, size_t len) {
+    while (len > 0) {
+        const ssize_t n = recv(fd, buf, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+
+        buf += n;
+        len -= static_cast<size_t>(n);
+    }
+
+    return true;
+}
+
+bool write_all(const int fd, const std::string &data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        const ssize_t n =
+            send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+
+        offset += static_cast<size_t>(n);
+    }
+
+    return true;
+}
+
+bool read_int32(const int fd, int32_t &val) {
+    uint32_t net = 0;
+    if (!read_exact(fd, reinterpret_cast<char *>(&net), sizeof(net))) {
+        return false;
+    }
+
+    val = static_cast<int32_t>(ntohl(net));
+    return true;
+}
+
+} // namespace
+
+namespace dpp_utils::bench {
+
+fake_pg_server::fake_pg_server(std::vector<column> columns,
+                               std::vector<std::vector<std::string>> rows)
+    : _columns(std::move(columns)), _rows(std::move(rows)) {}
+
+fake_pg_server::~fake_pg_server() { stop(); }
+
+void fake_pg_server::start() {
+    this->_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (this->_listen_fd < 0) {
+        throw std::runtime_error{"Couldn't create listening socket"};
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    socklen_t len = sizeof(addr);
+    if (bind(this->_listen_fd, reinterpret_cast<sockaddr *>(&addr), len) <
+            0 ||
+        listen(this->_listen_fd, 16) < 0 ||
+        getsockname(this->_listen_fd, reinterpret_cast<sockaddr *>(&addr),
+                    &len) < 0) {
+        close(this->_listen_fd);
+        throw std::runtime_error{"Couldn't listen on the loopback interface"};
+    }
+
+    this->_port = ntohs(addr.sin_port);
+    this->_running = true;
+    this->_thread = std::thread{[this]() { this->accept_loop(); }};
+}
+
+void fake_pg_server::stop() {
+    if (!this->_running.exchange(false)) {
+        return;
+    }
+
+    shutdown(this->_listen_fd, SHUT_RDWR);
+    close(this->_listen_fd);
+    this->_thread.join();
+}
+
+std::string fake_pg_server::connection_string() const {
+    return "host=127.0.0.1 port=" + std::to_string(this->_port) +
+           " user=bench dbname=bench sslmode=disable gssencmode=disable";
+}
+
+void fake_pg_server::accept_loop() {
+    while (this->_running) {
+        const int fd = accept(this->_listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        const int flag = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+        std::thread{[this, fd]() {
+            this->serve(fd);
+            close(fd);
+        }}.detach();
+    }
+}
+
+void fake_pg_server::serve(const int fd) const {
+    // Startup, possibly preceded by SSL or GSS encryption requests
+    while (true) {
+        int32_t len = 0;
+        int32_t code = 0;
+        if (!read_int32(fd, len) || !read_int32(fd, code) || len < 8) {
+            return;
+        }
+
+        std::string rest(static_cast<size_t>(len - 8), '\0');
+        if (!read_exact(fd, rest.data(), rest.size())) {
+            return;
+        }
+
+        if (code == SSL_REQUEST_CODE || code == GSSENC_REQUEST_CODE) {
+            if (!write_all(fd, "N")) {
+                return;
+            }
+            continue;
+        }
+
+        break;
+    }
+
+    std::string out;
+    message{'R'}.int32(0).append_to(out);
+    message{'S'}.str("client_encoding").str("UTF8").append_to(out);
+    message{'S'}.str("server_version").str("16.0").append_to(out);
+    message{'S'}.str("standard_conforming_strings").str("on").append_to(out);
+    message{'S'}.str("integer_datetimes").str("on").append_to(out);
+    message{'K'}.int32(1).int32(1).append_to(out);
+    message{'Z'}.bytes("I").append_to(out);
+    if (!write_all(fd, out)) {
+        return;
+    }
+
+    std::string row_description;
+    {
+        message desc{'T'};
+        desc.int16(static_cast<int16_t>(this->_columns.size()));
+        for (const auto &col : this->_columns) {
+            desc.str(col.name).int32(0).int16(0).int32(
+                static_cast<int32_t>(col.type_oid));
+            desc.int16(-1).int32(-1).int16(0);
+        }
+        desc.append_to(row_description);
+    }
+
+    std::string data_rows;
+    for (const auto &row : this->_rows) {
+        message data{'D'};
+        data.int16(static_cast<int16_t>(row.size()));
+        for (const auto &val : row) {
+            data.int32(static_cast<int32_t>(val.size())).bytes(val);
+        }
+        data.append_to(data_rows);
+    }
+    message{'C'}
+        .str("SELECT " + std::to_string(this->_rows.size()))
+        .append_to(data_rows);
+
+    out.clear();
+    while (true) {
+        char type = 0;
+        int32_t len = 0;
+        if (!read_exact(fd, &type, 1) || !read_int32(fd, len) || len < 4) {
+            return;
+        }
+
+        std::string body(static_cast<size_t>(len - 4), '\0');
+        if (!read_exact(fd, body.data(), body.size())) {
+            return;
+        }
+
+        switch (type) {
+        case 'P':
+            message{'1'}.append_to(out);
+            break;
+
+        case 'B':
+            message{'2'}.append_to(out);
+            break;
+
+        case 'D':
+            if (!body.empty() && body[0] == 'S') {
+                message{'t'}.int16(0).append_to(out);
+            }
+            out += row_description;
+            break;
+
+        case 'E':
+            out += data_rows;
+            break;
+
+        case 'Q':
+            out += row_description;
+            out += data_rows;
+            message{'Z'}.bytes("I").append_to(out);
+            break;
+
+        case 'S':
+            message{'Z'}.bytes("I").append_to(out);
+            break;
+
+        case 'H':
+            break;
+
+        case 'X':
+            return;
+
+        default:
+            message{'E'}
+                .bytes("S")
+                .str("ERROR")
+                .bytes("M")
+                .str("Unsupported message")
+                .bytes(std::string(1, '\0'))
+                .append_to(out);
+            break;
+        }
+
+        // Responses are only flushed when the client waits for them
+        if (type == 'S' || type == 'Q' || type == 'H') {
+            if (!write_all(fd, out)) {
+                return;
+            }
+            out.clear();
+        }
+    }
+}
+
+} // namespace dpp_utils::bench
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dpp_utils::bench {
+
+/**
+ * Minimal Postgres wire protocol server speaking just enough of the v3
+ * protocol for libpq to connect, prepare and run statements. Every executed
+ * statement answers with the same scripted rows, which keeps benchmarks
+ * repeatable without a real database.
+ */
+class fake_pg_server final {
+  public:
+    struct column {
+        std::string name;
+        uint32_t type_oid;
+    };
+
+  private:
+    std::vector<column> _columns;
+    std::vector<std::vector<std::string>> _rows;
+
+    int _listen_fd = -1;
+    uint16_t _port = 0;
+    std::atomic<bool> _running{false};
+    std::thread _thread{};
+
+    void accept_loop();
+
+    void serve(int fd) const;
+
+  public:
+    fake_pg_server(std::vector<column> columns,
+                   std::vector<std::vector<std::string>> rows);
+
+    ~fake_pg_server();
+
+    fake_pg_server(const fake_pg_server &) = delete;
+    fake_pg_server(fake_pg_server &&) = delete;
+
+    fake_pg_server &operator=(const fake_pg_server &) = delete;
+    fake_pg_server &operator=(fake_pg_server &&) = delete;
+
+    /**
+     * Starts listening on a free port on the loopback interface.
+     */
+    void start();
+
+    void stop();
+
+    std::string connection_string() const;
+};
+
+} // namespace dpp_utils::bench
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <dpp/appcommand.h>
+#include <dpp/dispatcher.h>
+
+#ifdef DPP_EXPORT_PG
+#include "database.h"
+#endif
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dpp_utils {
+
+/**
+ * Sorted array of suggestions searched by case-insensitive prefix. Readers
+ * work on an immutable snapshot, updates build a new one and swap it in, so
+ * lookups never wait on a refresh.
+ */
+class prefix_index final {
+  public:
+    struct entry {
+        std::string name;
+        dpp::command_value value;
+    };
+
+  private:
+    struct indexed_entry {
+        std::string key;
+        entry item;
+    };
+
+    using snapshot = std::vector<indexed_entry>;
+
+    mutable std::mutex _m{};
+    std::mutex _write_m{};
+    std::shared_ptr<const snapshot> _entries;
+
+    std::shared_ptr<const snapshot> get_snapshot() const;
+
+    void set_snapshot(snapshot &&entries);
+
+    /**
+     * Keys and sorts the entries, keeping only the last one of every name.
+     * The kept names are added to names.
+     */
+    static snapshot index_entries(std::vector<entry> &&entries,
+                                  std::unordered_set<std::string> &names);
+
+  public:
+    prefix_index();
+
+    prefix_index(const prefix_index &) = delete;
+    prefix_index(prefix_index &&) = delete;
+
+    prefix_index &operator=(const prefix_index &) = delete;
+    prefix_index &operator=(prefix_index &&) = delete;
+
+    /**
+     * Replaces every entry in the index. Of entries sharing a name only the
+     * last one is kept.
+     */
+    void assign(std::vector<entry> &&entries);
+
+    /**
+     * Adds the entries, replacing existing ones with the same name. Of
+     * entries sharing a name only the last one is kept.
+     */
+    void upsert(std::vector<entry> &&entries);
+
+    void erase(const std::vector<std::string> &names);
+
+    std::vector<entry> find(std::string_view prefix, size_t limit = 25) const;
+
+    size_t size() const;
+
+#ifdef DPP_EXPORT_PG
+    /**
+     * Fills the index from a query. The first column is used as the name and
+     * the second, if there is one, as the value. Integer and floating point
+     * values stay numbers, so the index can back integer and number options,
+     * and a NULL value falls back to the name. Rows with a NULL name or a
+     * value choices can't hold are skipped. With replace set to false the
+     * rows are upserted, which allows refreshing from a query that only
+     * selects changed rows. The index has to outlive the query.
+     */
+    void load(database &db, const std::string &stmnt,
+              database::param_strings &&params = {}, bool replace = true);
+
+    /**
+     * Fills the index from an already fetched result, the same way as the
+     * query overload. Errors are logged instead of thrown.
+     */
+    void load(const result &res, bool replace = true);
+#endif
+};
+
+using autocomplete_provider =
+    std::function<std::vector<dpp::command_option_choice>(
+        const dpp::autocomplete_t &, const std::string &)>;
+
+class autocomplete_dispatcher final {
+    std::unordered_map<std::string, autocomplete_provider> _providers{};
+
+  public:
+    autocomplete_dispatcher() = default;
+
+    autocomplete_dispatcher(const autocomplete_dispatcher &) = delete;
+    autocomplete_dispatcher(autocomplete_dispatcher &&) = delete;
+
+    autocomplete_dispatcher &
+    operator=(const autocomplete_dispatcher &) = delete;
+    autocomplete_dispatcher &operator=(autocomplete_dispatcher &&) = delete;
+
+    void add_provider(const std::string &command_name,
+                      const std::string &option_name,
+                      autocomplete_provider provider);
+
+    /**
+     * Answers the option straight from the index.
+     */
+    void add_index(const std::string &command_name,
+                   const std::string &option_name,
+                   std::shared_ptr<prefix_index> index);
+
+    /**
+     * Replies to the event with the suggestions for the focused option.
+     * Returns false if no provider was registered for it.
+     */
+    bool execute_autocomplete(const dpp::autocomplete_t &event) const;
+};
+
+} // namespace dpp_utils
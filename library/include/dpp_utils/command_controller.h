@@ -1,32 +1,177 @@
 #pragma once
 
+#include "command_profiler.h"
+
+#include <dpp/appcommand.h>
 #include <dpp/dispatcher.h>
 
+#ifdef DPP_CORO
+#include <dpp/coro.h>
+
+#include <coroutine>
+#endif
+
+#include <exception>
+#include <functional>
+#include <iostream>
 #include <optional>
+#include <stdexcept>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace dpp_utils {
 
+/**
+ * Schedules a unit of work, used to pick which thread coroutine commands are
+ * started on.
+ */
+using command_executor_fn = std::function<void(std::function<void()>)>;
+
+/**
+ * Called when a command handler, or binding its arguments, throws. Applies to
+ * both regular and coroutine handlers.
+ */
+using command_error_handler =
+    std::function<void(const dpp::slashcommand_t &, std::exception_ptr)>;
+
+/**
+ * Runs before a command is dispatched, returning false stops the event from
+ * reaching the handler.
+ */
+using command_middleware = std::function<bool(const dpp::slashcommand_t &)>;
+
 namespace internal {
 
 template <typename> struct function_info;
 
 template <typename ReturnType, typename... Args>
 struct function_info<ReturnType(Args...)> {
+    using return_type = ReturnType;
     using arguments = std::tuple<Args...>;
     static constexpr size_t arguments_count = sizeof...(Args);
 
-    template <size_t I> using nth_argument = std::tuple_element<I, arguments>;
+    template <size_t I> using nth_argument = std::tuple_element_t<I, arguments>;
 };
 
 struct command_executor_base {
+    virtual ~command_executor_base() = default;
+
     virtual void execute_command(const dpp::slashcommand_t &event) = 0;
+
+    /**
+     * Option definitions derived from the handler's parameters, in the order
+     * they appear in the signature.
+     */
+    virtual std::vector<dpp::command_option> get_options() const = 0;
+
+    /**
+     * Sets where coroutine handlers are started. When unset they start on the
+     * thread that received the event. Only the start is scheduled, after an
+     * awaited operation completes the handler continues on the thread that
+     * completed it.
+     */
+    void set_executor(command_executor_fn executor) {
+        this->_executor = std::move(executor);
+    }
+
+    void set_error_handler(command_error_handler handler) {
+        this->_error_handler = std::move(handler);
+    }
+
+    void set_profiler(std::shared_ptr<command_profiler> profiler,
+                      size_t slot) {
+        this->_profiler = std::move(profiler);
+        this->_profile_slot = slot;
+    }
+
+  protected:
+    command_executor_fn _executor{};
+    command_error_handler _error_handler{};
+    std::shared_ptr<command_profiler> _profiler{};
+    size_t _profile_slot = 0;
+
+    void handle_error(const dpp::slashcommand_t &event,
+                      std::exception_ptr exception) const {
+        if (this->_error_handler) {
+            this->_error_handler(event, std::move(exception));
+            return;
+        }
+
+        try {
+            std::rethrow_exception(exception);
+        } catch (const std::exception &e) {
+            std::cerr << "Command handler threw: " << e.what() << '\n';
+        } catch (...) {
+            std::cerr << "Command handler threw an unknown exception\n";
+        }
+    }
 };
 
 template <typename> struct is_optional : std::false_type {};
 
 template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
 
+template <typename> struct is_coroutine : std::false_type {};
+
+template <typename T>
+struct is_option_type
+    : std::bool_constant<
+          std::is_same_v<T, std::string> || std::is_same_v<T, int64_t> ||
+          std::is_same_v<T, bool> || std::is_same_v<T, double> ||
+          std::is_same_v<T, dpp::snowflake>> {};
+
+template <typename T> struct command_option_type {
+    static_assert(!sizeof(T), "Unsupported command handler parameter, use "
+                              "std::string, int64_t, bool, double or "
+                              "dpp::snowflake, optionally in std::optional");
+};
+
+template <> struct command_option_type<std::string> {
+    static constexpr dpp::command_option_type value = dpp::co_string;
+};
+
+template <> struct command_option_type<int64_t> {
+    static constexpr dpp::command_option_type value = dpp::co_integer;
+};
+
+template <> struct command_option_type<bool> {
+    static constexpr dpp::command_option_type value = dpp::co_boolean;
+};
+
+template <> struct command_option_type<double> {
+    static constexpr dpp::command_option_type value = dpp::co_number;
+};
+
+// Users, channels and roles all arrive as snowflakes, mentionable accepts
+// each of them. command_registry::set_option_type can narrow it down.
+template <> struct command_option_type<dpp::snowflake> {
+    static constexpr dpp::command_option_type value = dpp::co_mentionable;
+};
+
+#ifdef DPP_CORO
+template <typename T> struct is_coroutine<dpp::task<T>> : std::true_type {};
+
+template <typename T>
+struct is_coroutine<dpp::coroutine<T>> : std::true_type {};
+
+/**
+ * Awaitable that hands the awaiting coroutine over to an executor, or
+ * continues inline when none is set.
+ */
+struct resume_on {
+    const command_executor_fn &executor;
+
+    bool await_ready() const noexcept { return !executor; }
+
+    void await_suspend(std::coroutine_handle<> handle) const {
+        executor([handle]() { handle.resume(); });
+    }
+
+    void await_resume() const noexcept {}
+};
+#endif
+
 template <typename Function>
 struct command_executor final : public command_executor_base {
     Function &_function;
@@ -34,7 +179,27 @@ struct command_executor final : public command_executor_base {
 
     explicit command_executor(Function &function,
                               std::vector<std::string> &&options)
-        : _function(function), _options(std::move(options)) {}
+        : _function(function), _options(std::move(options)) {
+        static_assert(supported_parameters(
+                          std::make_index_sequence<info::arguments_count>{}),
+                      "Unsupported command handler parameter, use "
+                      "std::string, int64_t, bool, double or dpp::snowflake, "
+                      "optionally in std::optional");
+
+        // Discord rejects commands with an optional option before a
+        // required one
+        static_assert(required_options_first(
+                          std::make_index_sequence<info::arguments_count>{}),
+                      "Required handler parameters must come before "
+                      "std::optional ones");
+
+        if (this->_options.size() !=
+            count_options(std::make_index_sequence<info::arguments_count>{})) {
+            throw std::invalid_argument{
+                "The option names provided don't match the handler "
+                "parameters"};
+        }
+    }
 
     command_executor() = delete;
     command_executor(command_executor &&) = delete;
@@ -43,52 +208,200 @@ struct command_executor final : public command_executor_base {
     using info = function_info<Function>;
 
     void execute_command(const dpp::slashcommand_t &event) override {
-        process(event, 0);
+        if constexpr (is_coroutine<typename info::return_type>::value) {
+#ifdef DPP_CORO
+            run_coroutine(this, event);
+#endif
+        } else {
+            command_timer timer{this->_profiler.get(), this->_profile_slot};
+
+            try {
+                bound_arguments args = bind_arguments(
+                    event, std::make_index_sequence<info::arguments_count>{});
+                timer.bound();
+
+                std::apply(this->_function, std::move(args));
+                timer.handled();
+            } catch (...) {
+                timer.failed();
+                handle_error(event, std::current_exception());
+            }
+
+            timer.finish();
+        }
+    }
+
+    std::vector<dpp::command_option> get_options() const override {
+        std::vector<dpp::command_option> options;
+        append_options(options,
+                       std::make_index_sequence<info::arguments_count>{});
+        return options;
     }
 
   private:
-    template <typename... Args>
-    void process(const dpp::slashcommand_t &event, size_t args_offset,
-                 Args... args) {
-        constexpr size_t arg_count = sizeof...(Args);
+    // The event is bound by reference, everything else by value
+    template <typename T>
+    using bound_argument =
+        std::conditional_t<std::is_same_v<T, dpp::slashcommand_t>,
+                           std::reference_wrapper<const dpp::slashcommand_t>,
+                           T>;
+
+    template <typename> struct bound_tuple;
+
+    template <size_t... I> struct bound_tuple<std::index_sequence<I...>> {
+        using type = std::tuple<bound_argument<std::remove_cvref_t<
+            typename info::template nth_argument<I>>>...>;
+    };
 
-        if constexpr (arg_count < info::arguments_count) {
-            using current_arg = std::remove_const_t<std::remove_cvref_t<
-                typename info::template nth_argument<arg_count>>>;
+    using bound_arguments = typename bound_tuple<
+        std::make_index_sequence<info::arguments_count>>::type;
+
+    template <typename T> static constexpr bool is_supported_parameter() {
+        if constexpr (std::is_same_v<T, dpp::slashcommand_t>) {
+            return true;
+        } else if constexpr (is_optional<T>::value) {
+            return is_option_type<typename T::value_type>::value;
+        } else {
+            return is_option_type<T>::value;
+        }
+    }
+
+    template <size_t... I>
+    static constexpr bool supported_parameters(std::index_sequence<I...>) {
+        return (is_supported_parameter<std::remove_cvref_t<
+                    typename info::template nth_argument<I>>>() &&
+                ...);
+    }
+
+    template <size_t... I>
+    static constexpr bool required_options_first(std::index_sequence<I...>) {
+        bool seen_optional = false;
+        bool valid = true;
+
+        const auto visit = [&](const bool optional, const bool event) {
+            if (event) {
+                return;
+            }
+
+            if (optional) {
+                seen_optional = true;
+            } else if (seen_optional) {
+                valid = false;
+            }
+        };
+
+        (visit(is_optional<std::remove_cvref_t<
+                   typename info::template nth_argument<I>>>::value,
+               std::is_same_v<std::remove_cvref_t<
+                                  typename info::template nth_argument<I>>,
+                              dpp::slashcommand_t>),
+         ...);
+        return valid;
+    }
+
+    template <size_t... I>
+    void append_options(std::vector<dpp::command_option> &options,
+                        std::index_sequence<I...>) const {
+        (append_option<I>(options), ...);
+    }
+
+    template <size_t I>
+    void append_option(std::vector<dpp::command_option> &options) const {
+        using current_arg =
+            std::remove_cvref_t<typename info::template nth_argument<I>>;
+
+        if constexpr (!std::is_same_v<current_arg, dpp::slashcommand_t>) {
+            const std::string &name = this->_options.at(options.size());
 
             if constexpr (is_optional<current_arg>::value) {
                 using optional_type = typename current_arg::value_type;
-
-                const auto &param =
-                    event.get_parameter(this->_options.get(arg_count));
-                optional_type *type = std::get_if<optional_type>(&param);
-                if (type == nullptr) {
-                    return process(event, args_offset,
-                                   std::forward<Args>(args)..., std::nullopt);
-                } else {
-                    return process(event, args_offset,
-                                   std::forward<Args>(args)..., *type);
-                }
-            } else if constexpr (std::is_same_v<current_arg,
-                                                dpp::slashcommand_t>) {
-                return process(event, args_offset, std::forward<Args>(args)...,
-                               event);
+                options.emplace_back(
+                    command_option_type<optional_type>::value, name, name,
+                    false);
             } else {
-                current_arg arg = std::get<current_arg>(
-                    event.get_parameter(this->_options.get(arg_count)));
-                return process(event, args_offset, std::forward<Args>(args)...,
-                               arg);
+                options.emplace_back(command_option_type<current_arg>::value,
+                                     name, name, true);
             }
-        } else if constexpr (arg_count == info::arguments_count) {
-            return this->_function(std::forward<Args>(args)...);
+        }
+    }
+
+    template <size_t I> static constexpr bool is_event_parameter() {
+        return std::is_same_v<
+            std::remove_cvref_t<typename info::template nth_argument<I>>,
+            dpp::slashcommand_t>;
+    }
+
+    /**
+     * Number of options among the given parameters, so the index into
+     * _options of parameter I is count_options(make_index_sequence<I>).
+     */
+    template <size_t... I>
+    static constexpr size_t count_options(std::index_sequence<I...>) {
+        return (size_t{0} + ... + (is_event_parameter<I>() ? 0 : 1));
+    }
+
+    template <size_t... I>
+    bound_arguments bind_arguments(const dpp::slashcommand_t &event,
+                                   std::index_sequence<I...>) const {
+        return bound_arguments{bind_argument<I>(event)...};
+    }
+
+    template <size_t I>
+    auto bind_argument(const dpp::slashcommand_t &event) const {
+        using current_arg =
+            std::remove_cvref_t<typename info::template nth_argument<I>>;
+
+        if constexpr (std::is_same_v<current_arg, dpp::slashcommand_t>) {
+            return std::cref(event);
         } else {
-            throw std::runtime_error{"Impossible condition"};
+            const auto &param = event.get_parameter(
+                this->_options[count_options(std::make_index_sequence<I>{})]);
+
+            if constexpr (is_optional<current_arg>::value) {
+                using optional_type = typename current_arg::value_type;
+
+                const optional_type *value = std::get_if<optional_type>(&param);
+                return value == nullptr ? current_arg{} : current_arg{*value};
+            } else {
+                return std::get<current_arg>(param);
+            }
+        }
+    }
+
+#ifdef DPP_CORO
+    // The event and the bound arguments live in the job frame, so handlers
+    // taking them by reference stay valid across suspension points.
+    static dpp::job run_coroutine(command_executor *self,
+                                  dpp::slashcommand_t event) {
+        co_await resume_on{self->_executor};
+
+        command_timer timer{self->_profiler.get(), self->_profile_slot};
+        try {
+            bound_arguments args = self->bind_arguments(
+                event, std::make_index_sequence<info::arguments_count>{});
+            timer.bound();
+
+            auto handler = std::apply(self->_function, std::move(args));
+            timer.handled();
+
+            co_await std::move(handler);
+            timer.completed();
+        } catch (...) {
+            timer.failed();
+            self->handle_error(event, std::current_exception());
         }
+
+        timer.finish();
     }
+#endif
 };
 
 } // namespace internal
 
+class service_provider;
+
+using service_provider_ptr = std::shared_ptr<service_provider>;
+
 struct injectable_base {
     virtual ~injectable_base() = 0;
 };
@@ -158,8 +471,6 @@ class service_provider final {
   private:
 };
 
-using service_provider_ptr = std::shared_ptr<service_provider>;
-
 template <typename T> class injectable : public injectable_base {
   private:
     template <typename... Args>
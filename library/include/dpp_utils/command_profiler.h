@@ -0,0 +1,175 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dpp_utils {
+
+/**
+ * Collects per-command invocation counts and timings. Every thread records
+ * into its own counters, which are only merged when a snapshot is taken.
+ */
+class command_profiler final {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    struct span {
+        std::string_view command;
+        clock::time_point start;
+        clock::duration binding;
+        clock::duration handler;
+        // Time until a coroutine handler finished, zero for regular handlers
+        clock::duration completion;
+        bool failed;
+    };
+
+    using trace_sink = std::function<void(const span &)>;
+
+    struct command_stats {
+        std::string name;
+        uint64_t invocations;
+        uint64_t errors;
+        // Successful invocations that were timed, averages should divide
+        // by this
+        uint64_t sampled;
+        clock::duration binding;
+        clock::duration handler;
+        clock::duration completion;
+    };
+
+  private:
+    struct slot_counters {
+        uint64_t invocations = 0;
+        uint64_t errors = 0;
+        uint64_t sampled = 0;
+        clock::rep binding = 0;
+        clock::rep handler = 0;
+        clock::rep completion = 0;
+    };
+
+    struct thread_counters {
+        std::mutex m{};
+        std::vector<slot_counters> slots{};
+        uint64_t calls = 0;
+    };
+
+    const uint64_t _id;
+    const uint32_t _sample_every;
+    trace_sink _trace_sink;
+
+    mutable std::mutex _m{};
+    std::deque<std::string> _names{};
+    std::vector<std::shared_ptr<thread_counters>> _threads{};
+
+    thread_counters &local_counters();
+
+  public:
+    /**
+     * Only every sample_every-th invocation on a thread is timed, counts are
+     * always kept. Sampled invocations are also passed to the trace sink,
+     * failed ones included, but only successful ones add to the timings.
+     */
+    explicit command_profiler(uint32_t sample_every = 1,
+                              trace_sink sink = {});
+
+    command_profiler(const command_profiler &) = delete;
+    command_profiler(command_profiler &&) = delete;
+
+    command_profiler &operator=(const command_profiler &) = delete;
+    command_profiler &operator=(command_profiler &&) = delete;
+
+    /**
+     * Returns the slot the command records into. Commands should be
+     * registered before events are dispatched.
+     */
+    size_t register_command(const std::string &name);
+
+    bool should_sample();
+
+    void record(size_t slot, const span &timings, bool sampled);
+
+    std::vector<command_stats> snapshot() const;
+
+    void reset();
+};
+
+namespace internal {
+
+/**
+ * Measures a single invocation, does nothing when no profiler is attached.
+ */
+class command_timer {
+    command_profiler *_profiler;
+    size_t _slot;
+    bool _sampled = false;
+    bool _failed = false;
+
+    command_profiler::clock::time_point _start{};
+    command_profiler::clock::time_point _bound{};
+    command_profiler::clock::time_point _handled{};
+    command_profiler::clock::time_point _completed{};
+
+  public:
+    command_timer(command_profiler *profiler, size_t slot)
+        : _profiler(profiler), _slot(slot) {
+        if (this->_profiler != nullptr) {
+            this->_sampled = this->_profiler->should_sample();
+            if (this->_sampled) {
+                this->_start = command_profiler::clock::now();
+            }
+        }
+    }
+
+    void bound() {
+        if (this->_sampled) {
+            this->_bound = command_profiler::clock::now();
+        }
+    }
+
+    void handled() {
+        if (this->_sampled) {
+            this->_handled = command_profiler::clock::now();
+        }
+    }
+
+    void completed() {
+        if (this->_sampled) {
+            this->_completed = command_profiler::clock::now();
+        }
+    }
+
+    void failed() { this->_failed = true; }
+
+    void finish() {
+        if (this->_profiler == nullptr) {
+            return;
+        }
+
+        command_profiler::span timings{};
+        timings.start = this->_start;
+        timings.failed = this->_failed;
+
+        // A failed binding leaves the later time points unset
+        if (this->_sampled && this->_handled >= this->_bound &&
+            this->_bound >= this->_start) {
+            timings.binding = this->_bound - this->_start;
+            timings.handler = this->_handled - this->_bound;
+            if (this->_completed >= this->_handled) {
+                timings.completion = this->_completed - this->_start;
+            }
+        }
+
+        this->_profiler->record(this->_slot, timings, this->_sampled);
+    }
+};
+
+} // namespace internal
+
+} // namespace dpp_utils
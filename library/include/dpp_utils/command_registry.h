@@ -0,0 +1,140 @@
+#pragma once
+
+#include "command_controller.h"
+
+#include <dpp/cluster.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dpp_utils {
+
+/**
+ * The requests command_registry::sync_commands sends. The cluster overload
+ * of sync_commands goes through the Discord API, other implementations can
+ * stand in for it.
+ */
+struct command_sync_client {
+    using fetch_callback =
+        std::function<void(bool success, const dpp::slashcommand_map &)>;
+    using create_callback =
+        std::function<void(bool success, const dpp::slashcommand &)>;
+    using delete_callback = std::function<void(bool success)>;
+
+    virtual ~command_sync_client() = default;
+
+    virtual void fetch_commands(fetch_callback cb) = 0;
+
+    virtual void create_command(const dpp::slashcommand &command,
+                                create_callback cb) = 0;
+
+    virtual void delete_command(dpp::snowflake id, delete_callback cb) = 0;
+};
+
+class command_registry final {
+    struct entry {
+        std::string description;
+        std::unique_ptr<internal::command_executor_base> executor;
+        std::unordered_set<std::string> autocomplete{};
+        std::unordered_map<std::string, dpp::command_option_type>
+            option_types{};
+    };
+
+    std::unordered_map<std::string, entry> _commands{};
+    std::vector<command_middleware> _middlewares{};
+    std::shared_ptr<command_profiler> _profiler{};
+
+  public:
+    command_registry() = default;
+
+    command_registry(const command_registry &) = delete;
+    command_registry(command_registry &&) = delete;
+
+    command_registry &operator=(const command_registry &) = delete;
+    command_registry &operator=(command_registry &&) = delete;
+
+    /**
+     * Registers a handler under the given command name. The option names are
+     * matched, in order, with the handler parameters that aren't the event.
+     * Throws std::invalid_argument if their number differs.
+     */
+    template <typename Function>
+    internal::command_executor_base &
+    add_command(const std::string &name, const std::string &description,
+                Function &function, std::vector<std::string> &&options) {
+        auto executor = std::make_unique<internal::command_executor<Function>>(
+            function, std::move(options));
+        auto &ref = *executor;
+        if (this->_profiler != nullptr) {
+            ref.set_profiler(this->_profiler,
+                             this->_profiler->register_command(name));
+        }
+
+        this->_commands.insert_or_assign(
+            name, entry{description, std::move(executor)});
+        return ref;
+    }
+
+    /**
+     * Marks an option of an already registered command as autocompleted, see
+     * autocomplete_dispatcher for answering it.
+     */
+    void enable_autocomplete(const std::string &command_name,
+                             const std::string &option_name);
+
+    /**
+     * Narrows a dpp::snowflake option, which is registered as mentionable by
+     * default, to a user, channel or role option.
+     */
+    void set_option_type(const std::string &command_name,
+                         const std::string &option_name,
+                         dpp::command_option_type type);
+
+    /**
+     * Attaches the profiler to every registered command and to the ones
+     * added afterwards.
+     */
+    void set_profiler(std::shared_ptr<command_profiler> profiler);
+
+    /**
+     * Adds a middleware that runs, in insertion order, before every command.
+     */
+    void add_middleware(command_middleware middleware) {
+        this->_middlewares.emplace_back(std::move(middleware));
+    }
+
+    /**
+     * Dispatches the event to the handler registered under its command name.
+     * Returns false if no handler was found.
+     */
+    bool execute_command(const dpp::slashcommand_t &event) const;
+
+    std::vector<dpp::slashcommand>
+    build_commands(dpp::snowflake application_id) const;
+
+    /**
+     * Creates, updates and deletes global commands so they match the
+     * registered handlers, only sending the ones that changed.
+     *
+     * When manifest_path points at an existing manifest it is used as the
+     * remote state, otherwise the current definitions are fetched. The
+     * manifest is rewritten once all requests completed successfully.
+     */
+    void sync_commands(dpp::cluster &cluster,
+                       const std::string &manifest_path = "") const;
+
+    void sync_commands(std::shared_ptr<command_sync_client> client,
+                       dpp::snowflake application_id,
+                       const std::string &manifest_path = "") const;
+
+    /**
+     * Stable hash over the fields that make up a command definition, so
+     * locally built and fetched commands can be compared.
+     */
+    static uint64_t hash_command(const dpp::slashcommand &command);
+};
+
+} // namespace dpp_utils
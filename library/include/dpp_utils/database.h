@@ -10,7 +10,10 @@
 #include <mutex>
 #include <optional>
 #include <random>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace dpp_utils {
 
@@ -68,15 +71,51 @@ struct row_iterator {
 
 static_assert(std::forward_iterator<row_iterator>);
 
+/**
+ * The types result::column is instantiated for, the same ones row::get
+ * decodes.
+ */
+template <typename T>
+struct is_column_type
+    : std::bool_constant<
+          std::is_same_v<T, int64_t> || std::is_same_v<T, int32_t> ||
+          std::is_same_v<T, int16_t> || std::is_same_v<T, double> ||
+          std::is_same_v<T, float> || std::is_same_v<T, bool> ||
+          std::is_same_v<T, std::string>> {};
+
+/**
+ * A whole column decoded into contiguous storage. Null cells are left value
+ * initialised in values and flagged in null_bitmap.
+ */
+template <typename T> struct column_data {
+    static_assert(is_column_type<T>::value,
+                  "Columns can only be decoded as int64_t, int32_t, int16_t, "
+                  "double, float, bool or std::string");
+
+    // bool is stored as bytes, std::vector<bool> isn't contiguous
+    using value_type = std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>;
+
+    std::vector<value_type> values;
+    // Bit i % 64 of word i / 64 is set when row i is null
+    std::vector<uint64_t> null_bitmap;
+
+    bool is_null(size_t row_index) const {
+        return (this->null_bitmap[row_index / 64] >> (row_index % 64)) & 1;
+    }
+};
+
 class result {
     std::shared_ptr<PGresult> _result;
     std::string _error_message{};
 
-    explicit result(PGresult *result);
-
     friend class database;
 
   public:
+    /**
+     * Takes ownership of the given result.
+     */
+    explicit result(PGresult *result);
+
     result(result &&) = default;
     result(const result &) = default;
 
@@ -88,7 +127,43 @@ class result {
 
     std::string error() const;
 
+    int size() const;
+
+    int field_count() const;
+
     row operator[](int index) const;
+
+    /**
+     * Decodes every cell of the column in one pass. T has to match the column
+     * type exactly, the same types as row::value_variant are supported.
+     * With parallel set, columns of a few ten thousand rows or more are split
+     * into row ranges that are decoded on separate threads.
+     */
+    template <typename T>
+    column_data<T> column(int column_index, bool parallel = false) const;
+
+    template <typename T>
+    column_data<T> column(const std::string &column_name,
+                          bool parallel = false) const {
+        return column<T>(column_index(column_name), parallel);
+    }
+
+    /**
+     * Decodes the first sizeof...(Ts) columns, see column for parallel.
+     */
+    template <typename... Ts>
+    std::tuple<column_data<Ts>...> columns(bool parallel = false) const {
+        return columns<Ts...>(std::index_sequence_for<Ts...>{}, parallel);
+    }
+
+  private:
+    int column_index(const std::string &column_name) const;
+
+    template <typename... Ts, size_t... I>
+    std::tuple<column_data<Ts>...> columns(std::index_sequence<I...>,
+                                           bool parallel) const {
+        return {column<Ts>(static_cast<int>(I), parallel)...};
+    }
 };
 
 template <typename> struct to_param_string;
@@ -176,21 +251,22 @@ class database {
     void prepare(const std::string &stmnt, const query_callback &cb,
                  int params_count);
 
-  private:
-    template <typename... Args> param_strings get_param_strings(Args... args) {
+    template <typename... Args>
+    static param_strings get_param_strings(Args... args) {
         param_strings strings;
         return get_param_strings(std::move(strings),
                                  std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    param_strings get_param_strings(param_strings &&strings, Args... args) {
+    static param_strings get_param_strings(param_strings &&strings,
+                                           Args... args) {
         return strings;
     }
 
     template <typename T, typename... Args>
-    param_strings get_param_strings(param_strings &&strings, T value,
-                                    Args... args) {
+    static param_strings get_param_strings(param_strings &&strings, T value,
+                                           Args... args) {
         using NoCVRefT = std::remove_cvref_t<T>;
         static_assert(is_param_string_convertible<NoCVRefT>::value);
 
@@ -206,8 +282,9 @@ class database {
     }
 
     template <typename T, typename... Args>
-    param_strings get_param_strings(param_strings &&strings,
-                                    std::optional<T> value, Args... args) {
+    static param_strings get_param_strings(param_strings &&strings,
+                                           std::optional<T> value,
+                                           Args... args) {
         using NoCVRefT = std::remove_cvref_t<T>;
         static_assert(is_param_string_convertible<NoCVRefT>::value);
 
@@ -227,6 +304,7 @@ class database {
                                  std::forward<Args>(args)...);
     }
 
+  private:
     void on_read(dpp::socket fd, const dpp::socket_events &e);
 
     void process_result(PGresult *result);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "command_controller.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dpp_utils {
+
+/**
+ * Token bucket limits per user, guild and command. Buckets are spread over
+ * independently locked shards so concurrent events rarely contend, refilled
+ * lazily when touched and dropped once they are full again.
+ */
+class rate_limiter final {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    struct limit {
+        double capacity;
+        double refill_per_second;
+    };
+
+  private:
+    struct key {
+        uint64_t user_id;
+        uint64_t guild_id;
+        size_t command_hash;
+
+        bool operator==(const key &other) const = default;
+    };
+
+    struct key_hash {
+        size_t operator()(const key &k) const;
+    };
+
+    struct bucket {
+        double tokens;
+        clock::time_point last_refill;
+        const limit *bucket_limit;
+    };
+
+    struct alignas(64) shard {
+        std::mutex m{};
+        std::unordered_map<key, bucket, key_hash> buckets{};
+        size_t compact_cursor = 0;
+        std::vector<key> expired{};
+    };
+
+    limit _default_limit;
+    std::unordered_map<std::string, limit> _limits{};
+    std::unique_ptr<shard[]> _shards;
+    size_t _shard_mask;
+
+    const limit &get_limit(const std::string &command_name) const;
+
+    static bool is_full(const bucket &b, clock::time_point now);
+
+    static void compact_shard(shard &s, clock::time_point now);
+
+    static void compact_slice(shard &s, clock::time_point now);
+
+  public:
+    /**
+     * shard_count is rounded up to the next power of two.
+     */
+    explicit rate_limiter(limit default_limit, size_t shard_count = 64);
+
+    rate_limiter(const rate_limiter &) = delete;
+    rate_limiter(rate_limiter &&) = delete;
+
+    rate_limiter &operator=(const rate_limiter &) = delete;
+    rate_limiter &operator=(rate_limiter &&) = delete;
+
+    /**
+     * Overrides the limit for a single command. Must be called before events
+     * are dispatched, the limit table itself isn't synchronised.
+     */
+    void set_limit(const std::string &command_name, limit command_limit);
+
+    /**
+     * Takes a token from the bucket, returns false if it is empty. Also
+     * drops full buckets from a few hash buckets of the shard, so idle
+     * buckets don't pile up when compact() is never called.
+     */
+    bool try_acquire(uint64_t user_id, uint64_t guild_id,
+                     const std::string &command_name,
+                     clock::time_point now = clock::now());
+
+    /**
+     * Drops every bucket that has refilled to capacity, one shard at a time.
+     */
+    void compact(clock::time_point now = clock::now());
+
+    size_t size() const;
+};
+
+/**
+ * Middleware that rejects events over the limit, calling on_rejected so the
+ * user can be told about the cooldown. Without on_rejected an ephemeral
+ * cooldown message is sent, as the interaction would fail otherwise.
+ */
+command_middleware make_cooldown_middleware(
+    std::shared_ptr<rate_limiter> limiter,
+    std::function<void(const dpp::slashcommand_t &)> on_rejected = {});
+
+} // namespace dpp_utils
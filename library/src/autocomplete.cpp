@@ -0,0 +1,332 @@
+#include "autocomplete.h"
+
+#include <dpp/cluster.h>
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <optional>
+#include <unordered_set>
+
+namespace {
+
+std::string to_key(std::string_view str) {
+    std::string key;
+    key.reserve(str.size());
+
+    for (const char c : str) {
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    return key;
+}
+
+// Discord rejects the whole response when either limit is exceeded
+constexpr size_t max_choices = 25;
+constexpr size_t max_choice_name_length = 100;
+
+/**
+ * Cuts the name down to max_choice_name_length characters, counting UTF-8
+ * code points so no character is split.
+ */
+void truncate_name(std::string &name) {
+    size_t characters = 0;
+    for (size_t i = 0; i < name.size(); ++i) {
+        // Continuation bytes don't start a character
+        if ((static_cast<unsigned char>(name[i]) & 0xc0) == 0x80) {
+            continue;
+        }
+
+        if (characters++ == max_choice_name_length) {
+            name.resize(i);
+            return;
+        }
+    }
+}
+
+// Orders indexed entries, which are private to prefix_index
+constexpr auto by_key = [](const auto &a, const auto &b) {
+    return a.key < b.key;
+};
+
+std::string provider_key(const std::string &command_name,
+                         const std::string &option_name) {
+    // Command names can't contain spaces, so this can't collide
+    return command_name + ' ' + option_name;
+}
+
+#ifdef DPP_EXPORT_PG
+std::optional<std::string>
+to_choice_name(const dpp_utils::row::value_variant &cell) {
+    return std::visit(
+        [](const auto &value) -> std::optional<std::string> {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, std::string>) {
+                return value;
+            } else if constexpr (std::is_same_v<T, int64_t> ||
+                                 std::is_same_v<T, int32_t> ||
+                                 std::is_same_v<T, int16_t>) {
+                return std::to_string(value);
+            } else {
+                return std::nullopt;
+            }
+        },
+        cell);
+}
+
+/**
+ * Converts a cell into the value of a choice, NULL becomes an empty value.
+ * Choices can only hold strings, integers and numbers.
+ */
+std::optional<dpp::command_value>
+to_choice_value(const dpp_utils::row::value_variant &cell) {
+    return std::visit(
+        [](const auto &value) -> std::optional<dpp::command_value> {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, std::monostate> ||
+                          std::is_same_v<T, std::string> ||
+                          std::is_same_v<T, int64_t> ||
+                          std::is_same_v<T, double>) {
+                return value;
+            } else if constexpr (std::is_same_v<T, int32_t> ||
+                                 std::is_same_v<T, int16_t>) {
+                return int64_t{value};
+            } else if constexpr (std::is_same_v<T, float>) {
+                return double{value};
+            } else {
+                return std::nullopt;
+            }
+        },
+        cell);
+}
+#endif
+
+} // namespace
+
+namespace dpp_utils {
+
+prefix_index::prefix_index() : _entries(std::make_shared<const snapshot>()) {}
+
+std::shared_ptr<const prefix_index::snapshot>
+prefix_index::get_snapshot() const {
+    std::lock_guard lock{this->_m};
+    return this->_entries;
+}
+
+void prefix_index::set_snapshot(snapshot &&entries) {
+    auto new_entries = std::make_shared<const snapshot>(std::move(entries));
+
+    std::lock_guard lock{this->_m};
+    this->_entries = std::move(new_entries);
+}
+
+prefix_index::snapshot
+prefix_index::index_entries(std::vector<entry> &&entries,
+                            std::unordered_set<std::string> &names) {
+    snapshot indexed;
+    indexed.reserve(entries.size());
+
+    // Walking backwards keeps the last entry of every name in the batch
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        if (!names.emplace(it->name).second) {
+            continue;
+        }
+
+        std::string key = to_key(it->name);
+        indexed.emplace_back(indexed_entry{std::move(key), std::move(*it)});
+    }
+
+    std::sort(indexed.begin(), indexed.end(), by_key);
+    return indexed;
+}
+
+void prefix_index::assign(std::vector<entry> &&entries) {
+    std::unordered_set<std::string> names;
+    snapshot new_entries = index_entries(std::move(entries), names);
+
+    std::lock_guard lock{this->_write_m};
+    set_snapshot(std::move(new_entries));
+}
+
+void prefix_index::upsert(std::vector<entry> &&entries) {
+    std::unordered_set<std::string> names;
+    snapshot added = index_entries(std::move(entries), names);
+
+    std::lock_guard lock{this->_write_m};
+    std::shared_ptr<const snapshot> current = get_snapshot();
+
+    snapshot kept;
+    kept.reserve(current->size());
+    for (const auto &item : *current) {
+        if (!names.contains(item.item.name)) {
+            kept.emplace_back(item);
+        }
+    }
+
+    // Both sides are already sorted, so this stays a linear merge
+    snapshot merged;
+    merged.reserve(kept.size() + added.size());
+    std::merge(std::make_move_iterator(kept.begin()),
+               std::make_move_iterator(kept.end()),
+               std::make_move_iterator(added.begin()),
+               std::make_move_iterator(added.end()),
+               std::back_inserter(merged), by_key);
+
+    set_snapshot(std::move(merged));
+}
+
+void prefix_index::erase(const std::vector<std::string> &names) {
+    const std::unordered_set<std::string> removed{names.begin(), names.end()};
+
+    std::lock_guard lock{this->_write_m};
+    std::shared_ptr<const snapshot> current = get_snapshot();
+
+    snapshot kept;
+    kept.reserve(current->size());
+    for (const auto &item : *current) {
+        if (!removed.contains(item.item.name)) {
+            kept.emplace_back(item);
+        }
+    }
+
+    set_snapshot(std::move(kept));
+}
+
+std::vector<prefix_index::entry>
+prefix_index::find(const std::string_view prefix, const size_t limit) const {
+    const std::string key = to_key(prefix);
+    std::shared_ptr<const snapshot> entries = get_snapshot();
+
+    auto it = std::lower_bound(
+        entries->begin(), entries->end(), key,
+        [](const indexed_entry &a, const std::string &k) { return a.key < k; });
+
+    std::vector<entry> found;
+    for (; it != entries->end() && found.size() < limit; ++it) {
+        if (it->key.compare(0, key.size(), key) != 0) {
+            break;
+        }
+
+        found.emplace_back(it->item);
+    }
+
+    return found;
+}
+
+size_t prefix_index::size() const { return get_snapshot()->size(); }
+
+#ifdef DPP_EXPORT_PG
+void prefix_index::load(database &db, const std::string &stmnt,
+                        database::param_strings &&params, const bool replace) {
+    db.query(
+        stmnt,
+        [this, replace](const result &res) { load(res, replace); },
+        std::move(params));
+}
+
+void prefix_index::load(const result &res, const bool replace) {
+    if (!res.error().empty()) {
+        std::cerr << "Failed to load prefix index: " << res.error() << '\n';
+        return;
+    }
+
+    const bool has_value = res.field_count() > 1;
+
+    std::vector<entry> entries;
+    entries.reserve(res.size());
+    size_t skipped = 0;
+
+    // The query overload calls this on the socket thread, so nothing may
+    // escape it
+    try {
+        for (const row &r : res) {
+            std::optional<std::string> name = to_choice_name(r.get(0));
+            std::optional<dpp::command_value> value =
+                has_value ? to_choice_value(r.get(1)) : dpp::command_value{};
+            if (!name.has_value() || !value.has_value()) {
+                ++skipped;
+                continue;
+            }
+
+            if (std::holds_alternative<std::monostate>(*value)) {
+                value = *name;
+            }
+
+            entries.emplace_back(entry{std::move(*name), std::move(*value)});
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Failed to load prefix index: " << e.what() << '\n';
+        return;
+    }
+
+    if (skipped != 0) {
+        std::cerr << "Skipped " << skipped
+                  << " prefix index rows without a usable name or value\n";
+    }
+
+    if (replace) {
+        assign(std::move(entries));
+    } else {
+        upsert(std::move(entries));
+    }
+}
+#endif
+
+void autocomplete_dispatcher::add_provider(const std::string &command_name,
+                                           const std::string &option_name,
+                                           autocomplete_provider provider) {
+    this->_providers.insert_or_assign(provider_key(command_name, option_name),
+                                      std::move(provider));
+}
+
+void autocomplete_dispatcher::add_index(const std::string &command_name,
+                                        const std::string &option_name,
+                                        std::shared_ptr<prefix_index> index) {
+    add_provider(
+        command_name, option_name,
+        [index = std::move(index)](const dpp::autocomplete_t &,
+                                   const std::string &input) {
+            std::vector<dpp::command_option_choice> choices;
+            for (auto &item : index->find(input)) {
+                choices.emplace_back(item.name, std::move(item.value));
+            }
+
+            return choices;
+        });
+}
+
+bool autocomplete_dispatcher::execute_autocomplete(
+    const dpp::autocomplete_t &event) const {
+    for (const auto &option : event.options) {
+        if (!option.focused) {
+            continue;
+        }
+
+        auto it = this->_providers.find(provider_key(event.name, option.name));
+        if (it == this->_providers.end()) {
+            return false;
+        }
+
+        const std::string *input = std::get_if<std::string>(&option.value);
+        std::vector<dpp::command_option_choice> choices =
+            it->second(event, input == nullptr ? std::string{} : *input);
+
+        if (choices.size() > max_choices) {
+            choices.erase(choices.begin() + max_choices, choices.end());
+        }
+
+        dpp::interaction_response response{dpp::ir_autocomplete_reply};
+        for (auto &choice : choices) {
+            truncate_name(choice.name);
+            response.add_autocomplete_choice(choice);
+        }
+
+        event.owner->interaction_response_create(
+            event.command.id, event.command.token, response);
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace dpp_utils
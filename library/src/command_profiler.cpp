@@ -0,0 +1,132 @@
+#include "command_profiler.h"
+
+#include <atomic>
+#include <unordered_map>
+
+namespace {
+
+std::atomic<uint64_t> next_profiler_id{1};
+
+} // namespace
+
+namespace dpp_utils {
+
+command_profiler::command_profiler(const uint32_t sample_every,
+                                   trace_sink sink)
+    : _id(next_profiler_id.fetch_add(1)),
+      _sample_every(sample_every == 0 ? 1 : sample_every),
+      _trace_sink(std::move(sink)) {}
+
+command_profiler::thread_counters &command_profiler::local_counters() {
+    // Ids are never reused, so entries of destroyed profilers can't be
+    // picked up by a new one
+    thread_local std::unordered_map<uint64_t, std::shared_ptr<thread_counters>>
+        counters;
+    thread_local uint64_t last_id = 0;
+    thread_local thread_counters *last = nullptr;
+
+    if (last_id == this->_id) {
+        return *last;
+    }
+
+    auto &local = counters[this->_id];
+    if (local == nullptr) {
+        local = std::make_shared<thread_counters>();
+
+        std::lock_guard lock{this->_m};
+        this->_threads.emplace_back(local);
+    }
+
+    last_id = this->_id;
+    last = local.get();
+    return *last;
+}
+
+size_t command_profiler::register_command(const std::string &name) {
+    std::lock_guard lock{this->_m};
+    for (size_t i = 0; i < this->_names.size(); ++i) {
+        if (this->_names[i] == name) {
+            return i;
+        }
+    }
+
+    this->_names.emplace_back(name);
+    return this->_names.size() - 1;
+}
+
+bool command_profiler::should_sample() {
+    thread_counters &local = local_counters();
+    std::lock_guard lock{local.m};
+    return local.calls++ % this->_sample_every == 0;
+}
+
+void command_profiler::record(const size_t slot, const span &timings,
+                              const bool sampled) {
+    thread_counters &local = local_counters();
+
+    {
+        std::lock_guard lock{local.m};
+        if (local.slots.size() <= slot) {
+            local.slots.resize(slot + 1);
+        }
+
+        slot_counters &counters = local.slots[slot];
+        ++counters.invocations;
+        if (timings.failed) {
+            ++counters.errors;
+        }
+
+        // Failed invocations stop before every stage is timed, so they
+        // would pull the averages down
+        if (sampled && !timings.failed) {
+            ++counters.sampled;
+            counters.binding += timings.binding.count();
+            counters.handler += timings.handler.count();
+            counters.completion += timings.completion.count();
+        }
+    }
+
+    if (sampled && this->_trace_sink) {
+        span named = timings;
+        named.command = this->_names[slot];
+        this->_trace_sink(named);
+    }
+}
+
+std::vector<command_profiler::command_stats>
+command_profiler::snapshot() const {
+    std::lock_guard lock{this->_m};
+
+    std::vector<command_stats> stats;
+    stats.reserve(this->_names.size());
+    for (const auto &name : this->_names) {
+        stats.emplace_back(command_stats{name, 0, 0, 0, {}, {}, {}});
+    }
+
+    for (const auto &local : this->_threads) {
+        std::lock_guard local_lock{local->m};
+        for (size_t i = 0; i < local->slots.size() && i < stats.size(); ++i) {
+            const slot_counters &counters = local->slots[i];
+            command_stats &merged = stats[i];
+
+            merged.invocations += counters.invocations;
+            merged.errors += counters.errors;
+            merged.sampled += counters.sampled;
+            merged.binding += clock::duration{counters.binding};
+            merged.handler += clock::duration{counters.handler};
+            merged.completion += clock::duration{counters.completion};
+        }
+    }
+
+    return stats;
+}
+
+void command_profiler::reset() {
+    std::lock_guard lock{this->_m};
+    for (const auto &local : this->_threads) {
+        std::lock_guard local_lock{local->m};
+        local->slots.clear();
+    }
+}
+
+} // namespace dpp_utils
@@ -0,0 +1,367 @@
+#include "command_registry.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+
+namespace {
+
+constexpr uint64_t fnv_offset_basis = 14695981039346656037ULL;
+constexpr uint64_t fnv_prime = 1099511628211ULL;
+
+void hash_bytes(uint64_t &hash, const std::string &value) {
+    for (const char c : value) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= fnv_prime;
+    }
+
+    // Terminate every field so ("ab", "c") and ("a", "bc") differ
+    hash ^= 0xff;
+    hash *= fnv_prime;
+}
+
+void hash_option(uint64_t &hash, const dpp::command_option &option) {
+    hash_bytes(hash, std::to_string(static_cast<int>(option.type)));
+    hash_bytes(hash, option.name);
+    hash_bytes(hash, option.description);
+    hash_bytes(hash, option.required ? "1" : "0");
+    hash_bytes(hash, option.autocomplete ? "1" : "0");
+
+    hash_bytes(hash, std::to_string(option.options.size()));
+    for (const auto &sub_option : option.options) {
+        hash_option(hash, sub_option);
+    }
+}
+
+struct manifest_entry {
+    dpp::snowflake id;
+    uint64_t hash;
+};
+
+using manifest = std::unordered_map<std::string, manifest_entry>;
+
+std::optional<manifest> read_manifest(const std::string &path) {
+    std::ifstream file{path};
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+
+    manifest entries;
+    std::string name;
+    uint64_t id = 0;
+    uint64_t hash = 0;
+    while (file >> name >> id >> hash) {
+        entries.emplace(name, manifest_entry{dpp::snowflake(id), hash});
+    }
+
+    return entries;
+}
+
+void write_manifest(const std::string &path, const manifest &entries) {
+    std::ofstream file{path, std::ios::trunc};
+    if (!file.is_open()) {
+        std::cerr << "Couldn't write command manifest to " << path << '\n';
+        return;
+    }
+
+    for (const auto &[name, entry] : entries) {
+        file << name << ' ' << static_cast<uint64_t>(entry.id) << ' '
+             << entry.hash << '\n';
+    }
+}
+
+struct sync_state {
+    // Keeps the client alive until every request completed
+    std::shared_ptr<dpp_utils::command_sync_client> client;
+    std::mutex m{};
+    manifest entries{};
+    std::string manifest_path;
+    size_t pending = 0;
+    bool failed = false;
+
+    void complete() {
+        std::lock_guard lock{this->m};
+        if (--this->pending == 0 && !this->failed &&
+            !this->manifest_path.empty()) {
+            write_manifest(this->manifest_path, this->entries);
+        }
+    }
+};
+
+void apply_changes(std::shared_ptr<dpp_utils::command_sync_client> client,
+                   const std::vector<dpp::slashcommand> &commands,
+                   const manifest &remote, const std::string &manifest_path) {
+    auto state = std::make_shared<sync_state>();
+    state->client = client;
+    state->manifest_path = manifest_path;
+
+    std::vector<std::pair<dpp::slashcommand, uint64_t>> to_create;
+    std::vector<dpp::snowflake> to_delete;
+
+    for (const auto &command : commands) {
+        const uint64_t hash =
+            dpp_utils::command_registry::hash_command(command);
+
+        auto it = remote.find(command.name);
+        if (it != remote.end() && it->second.hash == hash) {
+            state->entries.emplace(command.name, it->second);
+        } else {
+            to_create.emplace_back(command, hash);
+        }
+    }
+
+    for (const auto &[name, entry] : remote) {
+        const bool exists =
+            std::any_of(commands.begin(), commands.end(),
+                        [&name](const auto &c) { return c.name == name; });
+        if (!exists) {
+            to_delete.emplace_back(entry.id);
+        }
+    }
+
+    if (to_create.empty() && to_delete.empty()) {
+        if (!manifest_path.empty()) {
+            write_manifest(manifest_path, state->entries);
+        }
+        return;
+    }
+
+    state->pending = to_create.size() + to_delete.size();
+
+    // Creating a command with an existing name overwrites it, so changed
+    // commands don't need to be deleted first
+    for (auto &[command, hash] : to_create) {
+        client->create_command(
+            command, [state, name = command.name, hash = hash](
+                         const bool success, const dpp::slashcommand &created) {
+                {
+                    std::lock_guard lock{state->m};
+                    if (success) {
+                        state->entries.insert_or_assign(
+                            name, manifest_entry{created.id, hash});
+                    } else {
+                        state->failed = true;
+                    }
+                }
+
+                state->complete();
+            });
+    }
+
+    for (const dpp::snowflake id : to_delete) {
+        client->delete_command(id, [state](const bool success) {
+            if (!success) {
+                std::lock_guard lock{state->m};
+                state->failed = true;
+            }
+
+            state->complete();
+        });
+    }
+}
+
+class cluster_sync_client final : public dpp_utils::command_sync_client {
+    dpp::cluster &_cluster;
+
+  public:
+    explicit cluster_sync_client(dpp::cluster &cluster) : _cluster(cluster) {}
+
+    void fetch_commands(fetch_callback cb) override {
+        this->_cluster.global_commands_get(
+            [cb = std::move(cb)](const dpp::confirmation_callback_t &res) {
+                if (res.is_error()) {
+                    std::cerr << "Failed to fetch commands: "
+                              << res.get_error().message << '\n';
+                    cb(false, {});
+                    return;
+                }
+
+                cb(true, res.get<dpp::slashcommand_map>());
+            });
+    }
+
+    void create_command(const dpp::slashcommand &command,
+                        create_callback cb) override {
+        this->_cluster.global_command_create(
+            command, [cb = std::move(cb), name = command.name](
+                         const dpp::confirmation_callback_t &res) {
+                if (res.is_error()) {
+                    std::cerr << "Failed to create command " << name << ": "
+                              << res.get_error().message << '\n';
+                    cb(false, {});
+                    return;
+                }
+
+                cb(true, res.get<dpp::slashcommand>());
+            });
+    }
+
+    void delete_command(const dpp::snowflake id, delete_callback cb) override {
+        this->_cluster.global_command_delete(
+            id, [cb = std::move(cb)](const dpp::confirmation_callback_t &res) {
+                if (res.is_error()) {
+                    std::cerr << "Failed to delete command: "
+                              << res.get_error().message << '\n';
+                    cb(false);
+                    return;
+                }
+
+                cb(true);
+            });
+    }
+};
+
+} // namespace
+
+namespace dpp_utils {
+
+void command_registry::set_profiler(
+    std::shared_ptr<command_profiler> profiler) {
+    this->_profiler = std::move(profiler);
+
+    for (auto &[name, entry] : this->_commands) {
+        if (this->_profiler == nullptr) {
+            entry.executor->set_profiler(nullptr, 0);
+        } else {
+            entry.executor->set_profiler(
+                this->_profiler, this->_profiler->register_command(name));
+        }
+    }
+}
+
+void command_registry::set_option_type(const std::string &command_name,
+                                       const std::string &option_name,
+                                       const dpp::command_option_type type) {
+    if (type != dpp::co_user && type != dpp::co_channel &&
+        type != dpp::co_role && type != dpp::co_mentionable) {
+        throw std::invalid_argument{
+            "Only user, channel, role or mentionable types can be set"};
+    }
+
+    auto it = this->_commands.find(command_name);
+    if (it == this->_commands.end()) {
+        throw std::invalid_argument{"The command name provided did not exist"};
+    }
+
+    const auto options = it->second.executor->get_options();
+    const bool is_snowflake =
+        std::any_of(options.begin(), options.end(), [&](const auto &o) {
+            return o.name == option_name && o.type == dpp::co_mentionable;
+        });
+    if (!is_snowflake) {
+        throw std::invalid_argument{
+            "The option provided isn't a dpp::snowflake parameter"};
+    }
+
+    it->second.option_types.insert_or_assign(option_name, type);
+}
+
+void command_registry::enable_autocomplete(const std::string &command_name,
+                                           const std::string &option_name) {
+    auto it = this->_commands.find(command_name);
+    if (it == this->_commands.end()) {
+        throw std::invalid_argument{"The command name provided did not exist"};
+    }
+
+    it->second.autocomplete.emplace(option_name);
+}
+
+bool command_registry::execute_command(
+    const dpp::slashcommand_t &event) const {
+    auto it = this->_commands.find(event.command.get_command_name());
+    if (it == this->_commands.end()) {
+        return false;
+    }
+
+    for (const auto &middleware : this->_middlewares) {
+        if (!middleware(event)) {
+            return true;
+        }
+    }
+
+    it->second.executor->execute_command(event);
+    return true;
+}
+
+std::vector<dpp::slashcommand>
+command_registry::build_commands(const dpp::snowflake application_id) const {
+    std::vector<dpp::slashcommand> commands;
+    commands.reserve(this->_commands.size());
+
+    for (const auto &[name, entry] : this->_commands) {
+        dpp::slashcommand command{name, entry.description, application_id};
+        for (auto &option : entry.executor->get_options()) {
+            auto type = entry.option_types.find(option.name);
+            if (type != entry.option_types.end()) {
+                option.type = type->second;
+            }
+
+            if (entry.autocomplete.contains(option.name)) {
+                option.set_auto_complete(true);
+            }
+
+            command.add_option(option);
+        }
+
+        commands.emplace_back(std::move(command));
+    }
+
+    return commands;
+}
+
+void command_registry::sync_commands(dpp::cluster &cluster,
+                                     const std::string &manifest_path) const {
+    sync_commands(std::make_shared<cluster_sync_client>(cluster),
+                  cluster.me.id, manifest_path);
+}
+
+void command_registry::sync_commands(
+    std::shared_ptr<command_sync_client> client,
+    const dpp::snowflake application_id,
+    const std::string &manifest_path) const {
+    std::vector<dpp::slashcommand> commands = build_commands(application_id);
+
+    if (!manifest_path.empty()) {
+        std::optional<manifest> remote = read_manifest(manifest_path);
+        if (remote.has_value()) {
+            apply_changes(client, commands, remote.value(), manifest_path);
+            return;
+        }
+    }
+
+    // The fetch callback keeps the client alive until the sync is done
+    auto &fetcher = *client;
+    fetcher.fetch_commands(
+        [client = std::move(client), commands = std::move(commands),
+         manifest_path](const bool success,
+                        const dpp::slashcommand_map &fetched) {
+            if (!success) {
+                return;
+            }
+
+            manifest remote;
+            for (const auto &[id, command] : fetched) {
+                remote.emplace(command.name,
+                               manifest_entry{id, hash_command(command)});
+            }
+
+            apply_changes(client, commands, remote, manifest_path);
+        });
+}
+
+uint64_t command_registry::hash_command(const dpp::slashcommand &command) {
+    uint64_t hash = fnv_offset_basis;
+    hash_bytes(hash, command.name);
+    hash_bytes(hash, command.description);
+
+    hash_bytes(hash, std::to_string(command.options.size()));
+    for (const auto &option : command.options) {
+        hash_option(hash, option);
+    }
+
+    return hash;
+}
+
+} // namespace dpp_utils
@@ -1,6 +1,10 @@
 #include "database.h"
 
+#include <algorithm>
+#include <charconv>
+#include <future>
 #include <iostream>
+#include <thread>
 
 #include "database_exception.h"
 
@@ -11,6 +15,79 @@ struct result_deleter {
     void operator()(PGresult *result) const { PQclear(result); }
 };
 
+namespace {
+
+template <typename T> struct column_oid;
+
+template <> struct column_oid<int64_t> {
+    static bool matches(Oid oid) { return oid == INT8OID; }
+};
+
+template <> struct column_oid<int32_t> {
+    static bool matches(Oid oid) { return oid == INT4OID; }
+};
+
+template <> struct column_oid<int16_t> {
+    static bool matches(Oid oid) { return oid == INT2OID; }
+};
+
+template <> struct column_oid<double> {
+    static bool matches(Oid oid) { return oid == FLOAT8OID; }
+};
+
+template <> struct column_oid<float> {
+    static bool matches(Oid oid) { return oid == FLOAT4OID; }
+};
+
+template <> struct column_oid<bool> {
+    static bool matches(Oid oid) { return oid == BOOLOID; }
+};
+
+template <> struct column_oid<std::string> {
+    static bool matches(Oid oid) {
+        return oid == TEXTOID || oid == VARCHAROID || oid == CHAROID;
+    }
+};
+
+template <typename T>
+typename dpp_utils::column_data<T>::value_type decode_value(const char *val,
+                                                            int len) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return std::string{val, static_cast<size_t>(len)};
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return val[0] == 't';
+    } else {
+        // from_chars skips the locale and allocation overhead of std::sto*
+        T value{};
+        auto [ptr, ec] = std::from_chars(val, val + len, value);
+        if (ec != std::errc{}) {
+            throw std::invalid_argument{"Couldn't parse column value"};
+        }
+
+        return value;
+    }
+}
+
+// Fewest rows a thread decodes, below this the thread startup dominates
+constexpr int min_chunk_rows = 16384;
+
+template <typename T>
+void decode_rows(dpp_utils::column_data<T> &data, PGresult *res,
+                 const int column_index, const int begin, const int end) {
+    for (int i = begin; i < end; ++i) {
+        if (PQgetisnull(res, i, column_index)) {
+            data.null_bitmap[i / 64] |= uint64_t{1} << (i % 64);
+            continue;
+        }
+
+        data.values[i] =
+            decode_value<T>(PQgetvalue(res, i, column_index),
+                            PQgetlength(res, i, column_index));
+    }
+}
+
+} // namespace
+
 namespace dpp_utils {
 
 row::row(std::shared_ptr<PGresult> result, int row_index)
@@ -50,11 +127,7 @@ row::value_variant row::get(const int column_index) const {
         return std::stol(val);
 
     case BOOLOID:
-        if (std::strcmp(val, "true")) {
-            return true;
-        } else {
-            return false;
-        }
+        return val[0] == 't';
 
     case FLOAT8OID:
         return std::stod(val);
@@ -97,10 +170,81 @@ std::string result::error() const {
                : this->_error_message;
 }
 
+int result::size() const { return PQntuples(this->_result.get()); }
+
+int result::field_count() const { return PQnfields(this->_result.get()); }
+
 row result::operator[](const int index) const {
     return row(this->_result, index);
 }
 
+int result::column_index(const std::string &column_name) const {
+    const int column_index =
+        PQfnumber(this->_result.get(), column_name.c_str());
+    if (column_index == -1) {
+        throw std::invalid_argument{"The column name provided did not exist"};
+    }
+
+    return column_index;
+}
+
+template <typename T>
+column_data<T> result::column(const int column_index,
+                              const bool parallel) const {
+    PGresult *res = this->_result.get();
+    if (column_index < 0 || column_index >= PQnfields(res)) {
+        throw std::out_of_range{"Column index is out of range"};
+    }
+
+    if (!column_oid<T>::matches(PQftype(res, column_index))) {
+        throw std::range_error{
+            "The column type does not match the requested type"};
+    }
+
+    const int rows = PQntuples(res);
+
+    column_data<T> data;
+    data.values.resize(rows);
+    data.null_bitmap.assign((rows + 63) / 64, 0);
+
+    int chunks = 1;
+    if (parallel) {
+        const int threads =
+            static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        chunks = std::clamp(rows / min_chunk_rows, 1, threads);
+    }
+
+    // Chunks cover whole bitmap words, so no two threads write the same word
+    const int chunk_rows = ((rows + chunks - 1) / chunks + 63) / 64 * 64;
+
+    // Declared after data, so a throwing chunk waits for the others before
+    // data is destroyed
+    std::vector<std::future<void>> futures;
+    futures.reserve(chunks - 1);
+    for (int begin = chunk_rows; begin < rows; begin += chunk_rows) {
+        const int end = std::min(rows, begin + chunk_rows);
+        futures.emplace_back(std::async(
+            std::launch::async, [&data, res, column_index, begin, end]() {
+                decode_rows<T>(data, res, column_index, begin, end);
+            }));
+    }
+
+    decode_rows<T>(data, res, column_index, 0, std::min(rows, chunk_rows));
+    for (auto &future : futures) {
+        future.get();
+    }
+
+    return data;
+}
+
+template column_data<int64_t> result::column<int64_t>(int, bool) const;
+template column_data<int32_t> result::column<int32_t>(int, bool) const;
+template column_data<int16_t> result::column<int16_t>(int, bool) const;
+template column_data<double> result::column<double>(int, bool) const;
+template column_data<float> result::column<float>(int, bool) const;
+template column_data<bool> result::column<bool>(int, bool) const;
+template column_data<std::string> result::column<std::string>(int, bool) const;
+
 database::database(const char *connection_string) {
     this->_conn = PQconnectdb(connection_string);
     if (PQstatus(this->_conn) != CONNECTION_OK) {
@@ -144,7 +288,8 @@ void database::query(const std::string &stmnt, const query_callback &cb,
     }
 
     const auto &name = this->_prepared_map[stmnt];
-    const char **arr = static_cast<const char **>(malloc(args.size()));
+    const char **arr = static_cast<const char **>(
+        malloc(args.size() * sizeof(const char *)));
 
     for (int i = 0; i < args.size(); ++i) {
         if (args[i].has_value()) {
@@ -0,0 +1,167 @@
+#include "rate_limiter.h"
+
+#include <algorithm>
+
+// Hash buckets of the shard's map checked for full buckets per acquisition,
+// which keeps the work done under the shard lock bounded
+#define COMPACT_SLICE 2
+
+namespace dpp_utils {
+
+size_t rate_limiter::key_hash::operator()(const key &k) const {
+    // splitmix64 finaliser over the combined fields
+    uint64_t x = k.user_id ^ (k.guild_id * 0x9e3779b97f4a7c15ULL) ^
+                 (static_cast<uint64_t>(k.command_hash) << 1);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<size_t>(x);
+}
+
+rate_limiter::rate_limiter(const limit default_limit, size_t shard_count)
+    : _default_limit(default_limit) {
+    size_t count = 1;
+    while (count < shard_count) {
+        count <<= 1;
+    }
+
+    this->_shards = std::make_unique<shard[]>(count);
+    this->_shard_mask = count - 1;
+}
+
+void rate_limiter::set_limit(const std::string &command_name,
+                             const limit command_limit) {
+    this->_limits.insert_or_assign(command_name, command_limit);
+}
+
+const rate_limiter::limit &
+rate_limiter::get_limit(const std::string &command_name) const {
+    auto it = this->_limits.find(command_name);
+    if (it == this->_limits.end()) {
+        return this->_default_limit;
+    }
+
+    return it->second;
+}
+
+bool rate_limiter::try_acquire(const uint64_t user_id, const uint64_t guild_id,
+                               const std::string &command_name,
+                               const clock::time_point now) {
+    const limit &command_limit = get_limit(command_name);
+    const key k{user_id, guild_id, std::hash<std::string>{}(command_name)};
+
+    // The upper bits pick the shard, the map uses the full hash for buckets
+    const size_t hash = key_hash{}(k);
+    shard &s =
+        this->_shards[(hash >> (sizeof(size_t) * 4)) & this->_shard_mask];
+
+    std::lock_guard lock{s.m};
+    compact_slice(s, now);
+
+    auto [it, inserted] = s.buckets.try_emplace(
+        k, bucket{command_limit.capacity, now, &command_limit});
+    bucket &b = it->second;
+
+    if (!inserted) {
+        const double elapsed =
+            std::chrono::duration<double>(now - b.last_refill).count();
+        if (elapsed > 0) {
+            b.tokens = std::min(command_limit.capacity,
+                                b.tokens +
+                                    elapsed * command_limit.refill_per_second);
+            b.last_refill = now;
+        }
+    }
+
+    if (b.tokens < 1) {
+        return false;
+    }
+
+    b.tokens -= 1;
+    return true;
+}
+
+void rate_limiter::compact(const clock::time_point now) {
+    for (size_t i = 0; i <= this->_shard_mask; ++i) {
+        shard &s = this->_shards[i];
+        std::lock_guard lock{s.m};
+        compact_shard(s, now);
+    }
+}
+
+bool rate_limiter::is_full(const bucket &b, const clock::time_point now) {
+    const double elapsed =
+        std::chrono::duration<double>(now - b.last_refill).count();
+
+    // A full bucket behaves exactly like a missing one
+    return b.tokens + elapsed * b.bucket_limit->refill_per_second >=
+           b.bucket_limit->capacity;
+}
+
+void rate_limiter::compact_shard(shard &s, const clock::time_point now) {
+    std::erase_if(s.buckets, [now](const auto &item) {
+        return is_full(item.second, now);
+    });
+}
+
+void rate_limiter::compact_slice(shard &s, const clock::time_point now) {
+    if (s.buckets.empty()) {
+        return;
+    }
+
+    const size_t bucket_count = s.buckets.bucket_count();
+    for (size_t i = 0; i < COMPACT_SLICE; ++i) {
+        // Rehashing changes the bucket count, so the cursor wraps with it
+        const size_t n = s.compact_cursor++ % bucket_count;
+        for (auto it = s.buckets.begin(n); it != s.buckets.end(n); ++it) {
+            if (is_full(it->second, now)) {
+                s.expired.emplace_back(it->first);
+            }
+        }
+    }
+
+    for (const key &k : s.expired) {
+        s.buckets.erase(k);
+    }
+    s.expired.clear();
+}
+
+size_t rate_limiter::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i <= this->_shard_mask; ++i) {
+        shard &s = this->_shards[i];
+        std::lock_guard lock{s.m};
+        total += s.buckets.size();
+    }
+
+    return total;
+}
+
+command_middleware make_cooldown_middleware(
+    std::shared_ptr<rate_limiter> limiter,
+    std::function<void(const dpp::slashcommand_t &)> on_rejected) {
+    return [limiter = std::move(limiter), on_rejected = std::move(on_rejected)](
+               const dpp::slashcommand_t &event) {
+        const bool allowed = limiter->try_acquire(
+            static_cast<uint64_t>(event.command.usr.id),
+            static_cast<uint64_t>(event.command.guild_id),
+            event.command.get_command_name());
+
+        if (allowed) {
+            return true;
+        }
+
+        if (on_rejected) {
+            on_rejected(event);
+        } else {
+            event.reply(dpp::message{"You're on cooldown, try again shortly."}
+                            .set_flags(dpp::m_ephemeral));
+        }
+
+        return false;
+    };
+}
+
+} // namespace dpp_utils
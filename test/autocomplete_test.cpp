@@ -0,0 +1,164 @@
+#include "test.h"
+
+#include <dpp_utils/autocomplete.h>
+
+#ifdef DPP_EXPORT_PG
+#include <postgresql/server/catalog/pg_type_d.h>
+#endif
+
+#include <algorithm>
+
+namespace {
+
+using entry = dpp_utils::prefix_index::entry;
+
+std::vector<std::string> names_of(const std::vector<entry> &entries) {
+    std::vector<std::string> names;
+    for (const auto &item : entries) {
+        names.emplace_back(item.name);
+    }
+
+    return names;
+}
+
+const entry *find_entry(const std::vector<entry> &entries,
+                        const std::string &name) {
+    auto it = std::find_if(entries.begin(), entries.end(),
+                           [&name](const entry &e) { return e.name == name; });
+    return it == entries.end() ? nullptr : &*it;
+}
+
+void test_find() {
+    dpp_utils::prefix_index index;
+    index.assign({{"Kiwi", std::string{"kiwi"}},
+                  {"apple", std::string{"apple"}},
+                  {"Apricot", int64_t{2}},
+                  {"avocado", 1.5},
+                  {"banana", std::string{"banana"}}});
+    CHECK(index.size() == 5);
+
+    // Prefixes match regardless of case, in key order
+    CHECK((names_of(index.find("A")) ==
+           std::vector<std::string>{"apple", "Apricot", "avocado"}));
+    CHECK((names_of(index.find("ap")) ==
+           std::vector<std::string>{"apple", "Apricot"}));
+    CHECK(names_of(index.find("KI")) == std::vector<std::string>{"Kiwi"});
+    CHECK(index.find("cherry").empty());
+
+    CHECK(index.find("", 2).size() == 2);
+    CHECK(index.find("a", 1).size() == 1);
+    CHECK(index.find("").size() == 5);
+
+    const std::vector<entry> found = index.find("apr");
+    CHECK(found.size() == 1 && std::get<int64_t>(found[0].value) == 2);
+}
+
+void test_upsert_and_erase() {
+    dpp_utils::prefix_index index;
+    index.assign({{"Kiwi", std::string{"old"}},
+                  {"banana", std::string{"banana"}}});
+
+    // Later entries of a batch win over earlier ones and the index
+    index.upsert({{"Kiwi", std::string{"first"}},
+                  {"cherry", std::string{"cherry"}},
+                  {"Kiwi", std::string{"last"}}});
+    CHECK(index.size() == 3);
+
+    const std::vector<entry> kiwis = index.find("kiwi");
+    CHECK(kiwis.size() == 1);
+    CHECK(kiwis.size() == 1 && std::get<std::string>(kiwis[0].value) == "last");
+
+    index.assign({{"date", int64_t{1}}, {"date", int64_t{2}}});
+    const std::vector<entry> dates = index.find("");
+    CHECK(dates.size() == 1 && std::get<int64_t>(dates[0].value) == 2);
+
+    index.assign({{"apple", std::string{"apple"}},
+                  {"banana", std::string{"banana"}},
+                  {"cherry", std::string{"cherry"}}});
+    index.erase({"banana", "missing"});
+    CHECK((names_of(index.find("")) ==
+           std::vector<std::string>{"apple", "cherry"}));
+}
+
+#ifdef DPP_EXPORT_PG
+using cell = std::optional<std::string>;
+
+dpp_utils::result make_result(const Oid name_type, const Oid value_type,
+                              const std::vector<std::pair<cell, cell>> &rows) {
+    PGresult *res = PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK);
+
+    PGresAttDesc attrs[2]{};
+    attrs[0].name = const_cast<char *>("name");
+    attrs[0].typid = name_type;
+    attrs[1].name = const_cast<char *>("value");
+    attrs[1].typid = value_type;
+    for (auto &attr : attrs) {
+        attr.typlen = -1;
+        attr.atttypmod = -1;
+    }
+    PQsetResultAttrs(res, 2, attrs);
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const cell *cells[2] = {&rows[i].first, &rows[i].second};
+        for (int c = 0; c < 2; ++c) {
+            if (cells[c]->has_value()) {
+                PQsetvalue(res, static_cast<int>(i), c,
+                           const_cast<char *>((*cells[c])->data()),
+                           static_cast<int>((*cells[c])->size()));
+            } else {
+                PQsetvalue(res, static_cast<int>(i), c, nullptr, -1);
+            }
+        }
+    }
+
+    return dpp_utils::result{res};
+}
+
+void test_load() {
+    dpp_utils::prefix_index index;
+
+    // NULL names are skipped, NULL values fall back to the name
+    index.load(make_result(TEXTOID, INT8OID,
+                           {{"apple", "1"},
+                            {std::nullopt, "2"},
+                            {"banana", std::nullopt},
+                            {"Kiwi", "565197576026980365"}}));
+    std::vector<entry> entries = index.find("");
+    CHECK(entries.size() == 3);
+
+    const entry *apple = find_entry(entries, "apple");
+    CHECK(apple != nullptr && std::get<int64_t>(apple->value) == 1);
+    const entry *banana = find_entry(entries, "banana");
+    CHECK(banana != nullptr &&
+          std::get<std::string>(banana->value) == "banana");
+    const entry *kiwi = find_entry(entries, "Kiwi");
+    CHECK(kiwi != nullptr &&
+          std::get<int64_t>(kiwi->value) == 565197576026980365);
+
+    // Integer names are stringified and bool values can't be choices
+    index.load(make_result(INT4OID, BOOLOID,
+                           {{"7", std::nullopt}, {"8", "t"}}),
+               false);
+    entries = index.find("");
+    CHECK(entries.size() == 4);
+    const entry *seven = find_entry(entries, "7");
+    CHECK(seven != nullptr && std::get<std::string>(seven->value) == "7");
+    CHECK(find_entry(entries, "8") == nullptr);
+
+    // Columns row::get can't decode leave the index untouched
+    index.load(make_result(TEXTOID, NUMERICOID, {{"cherry", "1.5"}}));
+    CHECK(index.size() == 4);
+}
+#endif
+
+} // namespace
+
+int main() {
+    test_find();
+    test_upsert_and_erase();
+#ifdef DPP_EXPORT_PG
+    test_load();
+#endif
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,150 @@
+#include "test.h"
+
+#include <dpp_utils/command_controller.h>
+
+#include <optional>
+#include <string>
+
+namespace {
+
+dpp::slashcommand_t make_event(std::vector<dpp::command_data_option> options) {
+    dpp::command_interaction interaction;
+    interaction.name = "test";
+    interaction.options = std::move(options);
+
+    dpp::slashcommand_t event;
+    event.command.data = interaction;
+    return event;
+}
+
+dpp::command_data_option make_option(const std::string &name,
+                                     const dpp::command_option_type type,
+                                     dpp::command_value value) {
+    dpp::command_data_option option;
+    option.name = name;
+    option.type = type;
+    option.value = std::move(value);
+    return option;
+}
+
+struct bound_values {
+    std::string name;
+    int64_t count = 0;
+    std::optional<bool> flag;
+    bool had_event = false;
+};
+
+bound_values bound;
+
+void bind_handler(const std::string &name, const dpp::slashcommand_t &event,
+                  int64_t count, std::optional<bool> flag) {
+    bound.name = name;
+    bound.count = count;
+    bound.flag = flag;
+    bound.had_event = event.command.id == 42;
+}
+
+void test_binding() {
+    dpp_utils::internal::command_executor<decltype(bind_handler)> executor{
+        bind_handler, {"name", "count", "flag"}};
+
+    dpp::slashcommand_t event =
+        make_event({make_option("name", dpp::co_string, std::string{"kiwi"}),
+                    make_option("count", dpp::co_integer, int64_t{3})});
+    event.command.id = 42;
+
+    executor.execute_command(event);
+    CHECK(bound.name == "kiwi");
+    CHECK(bound.count == 3);
+    CHECK(!bound.flag.has_value());
+    CHECK(bound.had_event);
+
+    event = make_event({make_option("name", dpp::co_string, std::string{"a"}),
+                        make_option("count", dpp::co_integer, int64_t{-1}),
+                        make_option("flag", dpp::co_boolean, true)});
+    executor.execute_command(event);
+    CHECK(bound.name == "a" && bound.count == -1);
+    CHECK(bound.flag.has_value() && *bound.flag);
+}
+
+void throwing_handler(const dpp::slashcommand_t &, int64_t) {
+    throw std::runtime_error{"handler failed"};
+}
+
+void test_errors() {
+    dpp_utils::internal::command_executor<decltype(throwing_handler)>
+        executor{throwing_handler, {"count"}};
+
+    int errors = 0;
+    executor.set_error_handler(
+        [&errors](const dpp::slashcommand_t &, std::exception_ptr) {
+            ++errors;
+        });
+
+    // Both the handler and binding a missing option throw
+    executor.execute_command(
+        make_event({make_option("count", dpp::co_integer, int64_t{1})}));
+    executor.execute_command(make_event({}));
+    CHECK(errors == 2);
+}
+
+#ifdef DPP_CORO
+std::coroutine_handle<> suspended{};
+
+/**
+ * Suspends the handler until the test resumes it, standing in for an
+ * awaited request.
+ */
+struct suspend_handler {
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) { suspended = handle; }
+
+    void await_resume() const noexcept {}
+};
+
+std::string resumed_name;
+int64_t resumed_count = 0;
+
+dpp::task<void> coroutine_handler(const dpp::slashcommand_t &,
+                                  const std::string &name,
+                                  const int64_t &count) {
+    co_await suspend_handler{};
+
+    resumed_name = name;
+    resumed_count = count;
+}
+
+void test_coroutine_references() {
+    dpp_utils::internal::command_executor<decltype(coroutine_handler)>
+        executor{coroutine_handler, {"name", "count"}};
+
+    {
+        // Longer than the small string buffer, so the value is on the heap
+        const dpp::slashcommand_t event = make_event(
+            {make_option("name", dpp::co_string, std::string(64, 'k')),
+             make_option("count", dpp::co_integer, int64_t{7})});
+        executor.execute_command(event);
+    }
+
+    CHECK(suspended != nullptr);
+    if (suspended != nullptr) {
+        std::exchange(suspended, nullptr).resume();
+    }
+
+    CHECK(resumed_name == std::string(64, 'k'));
+    CHECK(resumed_count == 7);
+}
+#endif
+
+} // namespace
+
+int main() {
+    test_binding();
+    test_errors();
+#ifdef DPP_CORO
+    test_coroutine_references();
+#endif
+
+    return TEST_RESULT();
+}
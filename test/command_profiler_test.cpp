@@ -0,0 +1,146 @@
+#include "test.h"
+
+#include <dpp_utils/command_profiler.h>
+
+#include <thread>
+
+namespace {
+
+using dpp_utils::command_profiler;
+using dpp_utils::internal::command_timer;
+
+void run_invocation(command_profiler &profiler, const size_t slot,
+                    const bool fail = false) {
+    command_timer timer{&profiler, slot};
+    if (fail) {
+        // Binding threw, so the handler never ran
+        timer.failed();
+    } else {
+        timer.bound();
+        timer.handled();
+    }
+
+    timer.finish();
+}
+
+const command_profiler::command_stats &
+find_stats(const std::vector<command_profiler::command_stats> &stats,
+           const std::string &name) {
+    for (const auto &command : stats) {
+        if (command.name == name) {
+            return command;
+        }
+    }
+
+    throw std::invalid_argument{"Command wasn't registered"};
+}
+
+void test_sampling() {
+    command_profiler profiler{3};
+    const size_t slot = profiler.register_command("ping");
+    CHECK(profiler.register_command("ping") == slot);
+
+    for (int i = 0; i < 9; ++i) {
+        run_invocation(profiler, slot);
+    }
+
+    const auto stats = profiler.snapshot();
+    CHECK(stats.size() == 1);
+    CHECK(stats[0].name == "ping");
+    CHECK(stats[0].invocations == 9);
+    CHECK(stats[0].sampled == 3);
+    CHECK(stats[0].errors == 0);
+}
+
+void test_errors() {
+    std::vector<command_profiler::span> spans;
+    command_profiler profiler{1, [&spans](const command_profiler::span &span) {
+                                  spans.emplace_back(span);
+                              }};
+    const size_t slot = profiler.register_command("ban");
+
+    run_invocation(profiler, slot);
+    run_invocation(profiler, slot, true);
+    run_invocation(profiler, slot, true);
+
+    const auto stats = profiler.snapshot();
+    CHECK(stats[0].invocations == 3);
+    CHECK(stats[0].errors == 2);
+    // Failed invocations are traced but kept out of the averages
+    CHECK(stats[0].sampled == 1);
+
+    CHECK(spans.size() == 3);
+    CHECK(spans.size() == 3 && spans[0].command == "ban" &&
+          !spans[0].failed && spans[1].failed && spans[2].failed);
+    CHECK(spans.size() == 3 &&
+          spans[1].binding == command_profiler::clock::duration::zero());
+}
+
+void test_threads() {
+    command_profiler profiler{2};
+    const size_t ping = profiler.register_command("ping");
+    const size_t ban = profiler.register_command("ban");
+
+    constexpr int thread_count = 4;
+    constexpr int iterations = 1000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&profiler, ping, ban]() {
+            for (int i = 0; i < iterations; ++i) {
+                run_invocation(profiler, ping);
+                run_invocation(profiler, ban, i % 10 == 0);
+            }
+        });
+    }
+
+    // Snapshots can be taken while threads are recording
+    profiler.snapshot();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    const auto stats = profiler.snapshot();
+    const auto &ping_stats = find_stats(stats, "ping");
+    const auto &ban_stats = find_stats(stats, "ban");
+
+    CHECK(ping_stats.invocations == thread_count * iterations);
+    CHECK(ping_stats.errors == 0);
+    CHECK(ban_stats.invocations == thread_count * iterations);
+    CHECK(ban_stats.errors == thread_count * iterations / 10);
+
+    // Every thread samples every second of its own invocations, which
+    // alternate between the commands
+    CHECK(ping_stats.sampled == thread_count * iterations);
+    CHECK(ban_stats.sampled == 0);
+}
+
+void test_reset() {
+    command_profiler profiler;
+    const size_t slot = profiler.register_command("ping");
+    run_invocation(profiler, slot);
+    run_invocation(profiler, slot, true);
+
+    profiler.reset();
+
+    const auto stats = profiler.snapshot();
+    CHECK(stats.size() == 1 && stats[0].name == "ping");
+    CHECK(stats[0].invocations == 0 && stats[0].errors == 0 &&
+          stats[0].sampled == 0);
+    CHECK(stats[0].binding == command_profiler::clock::duration::zero());
+
+    run_invocation(profiler, slot);
+    CHECK(profiler.snapshot()[0].invocations == 1);
+}
+
+} // namespace
+
+int main() {
+    test_sampling();
+    test_errors();
+    test_threads();
+    test_reset();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,242 @@
+#include "test.h"
+
+#include <dpp/json.h>
+#include <dpp_utils/command_registry.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+namespace {
+
+void ping(const dpp::slashcommand_t &) {}
+
+void ban(const dpp::slashcommand_t &, dpp::snowflake,
+         std::optional<std::string>) {}
+
+void echo(const dpp::slashcommand_t &, std::string) {}
+
+void fail(const dpp::slashcommand_t &) {}
+
+/**
+ * Answers every request immediately, standing in for the Discord API.
+ */
+class fake_sync_client final : public dpp_utils::command_sync_client {
+  public:
+    dpp::slashcommand_map remote{};
+    std::unordered_set<std::string> failing{};
+
+    int fetches = 0;
+    std::vector<std::string> created{};
+    std::vector<dpp::snowflake> deleted{};
+
+    uint64_t next_id = 1000;
+
+    void fetch_commands(fetch_callback cb) override {
+        ++this->fetches;
+        cb(true, this->remote);
+    }
+
+    void create_command(const dpp::slashcommand &command,
+                        create_callback cb) override {
+        this->created.emplace_back(command.name);
+        if (this->failing.contains(command.name)) {
+            cb(false, {});
+            return;
+        }
+
+        dpp::slashcommand result = command;
+        result.id = this->next_id++;
+        cb(true, result);
+    }
+
+    void delete_command(const dpp::snowflake id, delete_callback cb) override {
+        this->deleted.emplace_back(id);
+        cb(true);
+    }
+};
+
+bool contains(const std::vector<std::string> &names, const std::string &name) {
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+std::string read_file(const std::filesystem::path &path) {
+    std::ifstream file{path};
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+/**
+ * The manifest lines in name order, since they are written in map order.
+ */
+std::vector<std::string> read_lines(const std::filesystem::path &path) {
+    std::ifstream file{path};
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        lines.emplace_back(line);
+    }
+
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+void register_commands(dpp_utils::command_registry &registry) {
+    registry.add_command("ping", "Pong", ping, {});
+    registry.add_command("ban", "Bans a user", ban, {"user", "reason"});
+    registry.add_command("echo", "Repeats the text", echo, {"text"});
+}
+
+dpp::slashcommand find_command(const dpp_utils::command_registry &registry,
+                               const std::string &name) {
+    for (auto &command : registry.build_commands(42)) {
+        if (command.name == name) {
+            return command;
+        }
+    }
+
+    return {};
+}
+
+void test_fetched_hash_matches_local() {
+    dpp_utils::command_registry registry;
+    register_commands(registry);
+
+    // The shape Discord returns, with server side fields and the defaults
+    // for optional options left out
+    dpp::json json = dpp::json::parse(R"({
+        "id": "1", "application_id": "42", "version": "1", "type": 1,
+        "name": "ban", "description": "Bans a user",
+        "default_member_permissions": null, "dm_permission": true,
+        "options": [
+            {"type": 9, "name": "user", "description": "user",
+             "required": true},
+            {"type": 3, "name": "reason", "description": "reason"}
+        ]
+    })");
+
+    dpp::slashcommand fetched;
+    fetched.fill_from_json(&json);
+
+    const dpp::slashcommand local = find_command(registry, "ban");
+    CHECK(dpp_utils::command_registry::hash_command(fetched) ==
+          dpp_utils::command_registry::hash_command(local));
+
+    dpp::slashcommand changed = local;
+    changed.description = "Bans someone";
+    CHECK(dpp_utils::command_registry::hash_command(changed) !=
+          dpp_utils::command_registry::hash_command(local));
+
+    changed = local;
+    changed.options[1].required = true;
+    CHECK(dpp_utils::command_registry::hash_command(changed) !=
+          dpp_utils::command_registry::hash_command(local));
+}
+
+void test_sync(const std::filesystem::path &manifest_path) {
+    std::filesystem::remove(manifest_path);
+
+    dpp_utils::command_registry registry;
+    register_commands(registry);
+
+    // Without a manifest the fetched commands are the remote state
+    auto client = std::make_shared<fake_sync_client>();
+    dpp::slashcommand unchanged = find_command(registry, "ping");
+    unchanged.id = 1;
+    dpp::slashcommand outdated = find_command(registry, "echo");
+    outdated.id = 2;
+    outdated.description = "Old description";
+    dpp::slashcommand removed{"old", "Removed command", 42};
+    removed.id = 3;
+    client->remote = {{unchanged.id, unchanged},
+                      {outdated.id, outdated},
+                      {removed.id, removed}};
+
+    registry.sync_commands(client, 42, manifest_path.string());
+
+    CHECK(client->fetches == 1);
+    CHECK(client->created.size() == 2);
+    CHECK(contains(client->created, "ban"));
+    CHECK(contains(client->created, "echo"));
+    CHECK(client->deleted.size() == 1);
+    CHECK(client->deleted.size() == 1 && client->deleted[0] == removed.id);
+
+    const std::string manifest = read_file(manifest_path);
+    CHECK(manifest.find("ping 1 ") != std::string::npos);
+    CHECK(manifest.find("ban ") != std::string::npos);
+    CHECK(manifest.find("echo ") != std::string::npos);
+    CHECK(manifest.find("old ") == std::string::npos);
+    const std::vector<std::string> manifest_lines = read_lines(manifest_path);
+
+    // The manifest round trips, so nothing is fetched or sent
+    auto second = std::make_shared<fake_sync_client>();
+    registry.sync_commands(second, 42, manifest_path.string());
+    CHECK(second->fetches == 0);
+    CHECK(second->created.empty());
+    CHECK(second->deleted.empty());
+    CHECK(read_lines(manifest_path) == manifest_lines);
+
+    // Only the changed command is sent again
+    registry.add_command("echo", "Repeats text", echo, {"text"});
+    auto third = std::make_shared<fake_sync_client>();
+    registry.sync_commands(third, 42, manifest_path.string());
+    CHECK(third->created == std::vector<std::string>{"echo"});
+    CHECK(third->deleted.empty());
+
+    // A failed request leaves the manifest untouched, so the next start
+    // retries it
+    const std::string before_failure = read_file(manifest_path);
+    registry.add_command("fail", "Fails to register", fail, {});
+    auto failing = std::make_shared<fake_sync_client>();
+    failing->failing.emplace("fail");
+    registry.sync_commands(failing, 42, manifest_path.string());
+    CHECK(failing->created == std::vector<std::string>{"fail"});
+    CHECK(read_file(manifest_path) == before_failure);
+
+    auto retry = std::make_shared<fake_sync_client>();
+    registry.sync_commands(retry, 42, manifest_path.string());
+    CHECK(retry->created == std::vector<std::string>{"fail"});
+    CHECK(read_file(manifest_path).find("fail ") != std::string::npos);
+
+    std::filesystem::remove(manifest_path);
+}
+
+void test_build_commands() {
+    dpp_utils::command_registry registry;
+    register_commands(registry);
+    registry.set_option_type("ban", "user", dpp::co_user);
+
+    const dpp::slashcommand command = find_command(registry, "ban");
+    CHECK(command.options.size() == 2);
+    CHECK(command.options[0].type == dpp::co_user);
+    CHECK(command.options[0].required);
+    CHECK(command.options[1].type == dpp::co_string);
+    CHECK(!command.options[1].required);
+
+    CHECK_THROWS(registry.set_option_type("echo", "text", dpp::co_user),
+                 std::invalid_argument);
+}
+
+void test_option_count() {
+    dpp_utils::command_registry registry;
+
+    CHECK_THROWS(registry.add_command("ban", "Bans a user", ban, {"user"}),
+                 std::invalid_argument);
+    CHECK_THROWS(registry.add_command("ping", "Pong", ping, {"extra"}),
+                 std::invalid_argument);
+    CHECK(registry.build_commands(42).empty());
+}
+
+} // namespace
+
+int main() {
+    test_fetched_hash_matches_local();
+    test_sync(std::filesystem::temp_directory_path() /
+              "dpp_utils_command_manifest_test.txt");
+    test_build_commands();
+    test_option_count();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,109 @@
+#include "test.h"
+
+#include <dpp_utils/rate_limiter.h>
+
+namespace {
+
+using time_point = dpp_utils::rate_limiter::clock::time_point;
+using namespace std::chrono_literals;
+
+void test_rejects_and_refills() {
+    dpp_utils::rate_limiter limiter{{2, 1}};
+    const time_point start{};
+
+    CHECK(limiter.try_acquire(1, 10, "ping", start));
+    CHECK(limiter.try_acquire(1, 10, "ping", start));
+    CHECK(!limiter.try_acquire(1, 10, "ping", start));
+
+    // Users, guilds and commands have their own buckets
+    CHECK(limiter.try_acquire(2, 10, "ping", start));
+    CHECK(limiter.try_acquire(1, 11, "ping", start));
+    CHECK(limiter.try_acquire(1, 10, "echo", start));
+
+    // Half a token isn't enough
+    CHECK(!limiter.try_acquire(1, 10, "ping", start + 500ms));
+    CHECK(limiter.try_acquire(1, 10, "ping", start + 1s));
+    CHECK(!limiter.try_acquire(1, 10, "ping", start + 1s));
+
+    // Refilling stops at the capacity
+    CHECK(limiter.try_acquire(1, 10, "ping", start + 60s));
+    CHECK(limiter.try_acquire(1, 10, "ping", start + 60s));
+    CHECK(!limiter.try_acquire(1, 10, "ping", start + 60s));
+}
+
+void test_command_limit() {
+    dpp_utils::rate_limiter limiter{{1, 1}};
+    limiter.set_limit("ban", {1, 0.1});
+    const time_point start{};
+
+    CHECK(limiter.try_acquire(1, 10, "ban", start));
+    CHECK(limiter.try_acquire(1, 10, "ping", start));
+
+    CHECK(limiter.try_acquire(1, 10, "ping", start + 1s));
+    CHECK(!limiter.try_acquire(1, 10, "ban", start + 1s));
+    CHECK(limiter.try_acquire(1, 10, "ban", start + 10s));
+}
+
+void test_compact() {
+    dpp_utils::rate_limiter limiter{{2, 1}};
+    const time_point start{};
+
+    for (uint64_t user_id = 0; user_id < 100; ++user_id) {
+        limiter.try_acquire(user_id, 10, "ping", start);
+    }
+    CHECK(limiter.size() == 100);
+
+    // None of the buckets refilled yet
+    limiter.compact(start + 500ms);
+    CHECK(limiter.size() == 100);
+
+    limiter.compact(start + 1s);
+    CHECK(limiter.size() == 0);
+}
+
+void test_incremental_compaction() {
+    // A single shard so every acquisition compacts the same map
+    dpp_utils::rate_limiter limiter{{2, 1}, 1};
+    const time_point start{};
+
+    for (uint64_t user_id = 0; user_id < 1000; ++user_id) {
+        limiter.try_acquire(user_id, 10, "ping", start);
+    }
+    CHECK(limiter.size() == 1000);
+
+    // Each acquisition only visits a few hash buckets
+    limiter.try_acquire(0, 10, "ping", start + 1s);
+    CHECK(limiter.size() > 900);
+
+    for (int i = 0; i < 2000; ++i) {
+        limiter.try_acquire(0, 10, "ping", start + 1s);
+    }
+    CHECK(limiter.size() == 1);
+}
+
+void test_cooldown_middleware() {
+    auto limiter = std::make_shared<dpp_utils::rate_limiter>(
+        dpp_utils::rate_limiter::limit{1, 0.001});
+
+    int rejected = 0;
+    dpp_utils::command_middleware middleware =
+        dpp_utils::make_cooldown_middleware(
+            limiter, [&rejected](const dpp::slashcommand_t &) { ++rejected; });
+
+    dpp::slashcommand_t event;
+    CHECK(middleware(event));
+    CHECK(!middleware(event));
+    CHECK(rejected == 1);
+}
+
+} // namespace
+
+int main() {
+    test_rejects_and_refills();
+    test_command_limit();
+    test_compact();
+    test_incremental_compaction();
+    test_cooldown_middleware();
+
+    return TEST_RESULT();
+}
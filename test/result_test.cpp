@@ -0,0 +1,181 @@
+#include "test.h"
+
+#include <dpp_utils/database.h>
+
+#include <postgresql/server/catalog/pg_type_d.h>
+
+#include <optional>
+
+namespace {
+
+struct column_spec {
+    const char *name;
+    Oid type;
+};
+
+using cell = std::optional<std::string>;
+
+/**
+ * Builds a result without a server, std::nullopt cells are NULL.
+ */
+dpp_utils::result make_result(const std::vector<column_spec> &columns,
+                              const std::vector<std::vector<cell>> &rows) {
+    PGresult *res = PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK);
+
+    std::vector<PGresAttDesc> attrs(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        attrs[i].name = const_cast<char *>(columns[i].name);
+        attrs[i].typid = columns[i].type;
+        attrs[i].typlen = -1;
+        attrs[i].atttypmod = -1;
+    }
+    PQsetResultAttrs(res, static_cast<int>(attrs.size()), attrs.data());
+
+    for (size_t r = 0; r < rows.size(); ++r) {
+        for (size_t c = 0; c < rows[r].size(); ++c) {
+            const cell &value = rows[r][c];
+            if (value.has_value()) {
+                PQsetvalue(res, static_cast<int>(r), static_cast<int>(c),
+                           const_cast<char *>(value->data()),
+                           static_cast<int>(value->size()));
+            } else {
+                PQsetvalue(res, static_cast<int>(r), static_cast<int>(c),
+                           nullptr, -1);
+            }
+        }
+    }
+
+    return dpp_utils::result{res};
+}
+
+void test_column_nulls() {
+    std::vector<std::vector<cell>> rows;
+    for (int i = 0; i < 130; ++i) {
+        if (i % 3 == 0) {
+            rows.push_back({std::nullopt, std::nullopt});
+        } else {
+            rows.push_back({std::to_string(i), "name_" + std::to_string(i)});
+        }
+    }
+
+    dpp_utils::result res =
+        make_result({{"id", INT8OID}, {"name", TEXTOID}}, rows);
+
+    const auto ids = res.column<int64_t>(0);
+    const auto names = res.column<std::string>("name");
+    CHECK(ids.values.size() == 130);
+    // 130 rows span three bitmap words
+    CHECK(ids.null_bitmap.size() == 3);
+
+    bool matches = true;
+    for (size_t i = 0; i < 130; ++i) {
+        if (i % 3 == 0) {
+            matches &= ids.is_null(i) && names.is_null(i);
+            matches &= ids.values[i] == 0 && names.values[i].empty();
+        } else {
+            matches &= !ids.is_null(i) && !names.is_null(i);
+            matches &= ids.values[i] == static_cast<int64_t>(i);
+            matches &= names.values[i] == "name_" + std::to_string(i);
+        }
+    }
+    CHECK(matches);
+}
+
+void test_column_types() {
+    dpp_utils::result res = make_result(
+        {{"flag", BOOLOID},
+         {"small", INT2OID},
+         {"regular", INT4OID},
+         {"single", FLOAT4OID},
+         {"score", FLOAT8OID}},
+        {{"t", "-12", "123456", "0.5", "-2.25"},
+         {"f", "7", "-1", "1.5", "1e3"},
+         {std::nullopt, std::nullopt, std::nullopt, std::nullopt,
+          std::nullopt}});
+
+    const auto flags = res.column<bool>(0);
+    static_assert(std::is_same_v<decltype(flags.values), std::vector<uint8_t>>);
+    CHECK(flags.values[0] == 1);
+    CHECK(flags.values[1] == 0);
+    CHECK(flags.is_null(2));
+
+    const auto small = res.column<int16_t>(1);
+    CHECK(small.values[0] == -12 && small.values[1] == 7);
+
+    const auto regular = res.column<int32_t>(2);
+    CHECK(regular.values[0] == 123456 && regular.values[1] == -1);
+
+    const auto single = res.column<float>(3);
+    CHECK(single.values[0] == 0.5f && single.values[1] == 1.5f);
+
+    const auto score = res.column<double>(4);
+    CHECK(score.values[0] == -2.25 && score.values[1] == 1000.0);
+    CHECK(score.is_null(2));
+
+    const auto [flags_again, small_again] = res.columns<bool, int16_t>();
+    CHECK(flags_again.values == flags.values);
+    CHECK(small_again.values == small.values);
+}
+
+void test_column_errors() {
+    dpp_utils::result res =
+        make_result({{"id", INT8OID}, {"name", TEXTOID}}, {{"1", "a"}});
+
+    CHECK_THROWS(res.column<int32_t>(0), std::range_error);
+    CHECK_THROWS(res.column<std::string>(0), std::range_error);
+    CHECK_THROWS(res.column<int64_t>(1), std::range_error);
+    CHECK_THROWS(res.column<int64_t>(2), std::out_of_range);
+    CHECK_THROWS(res.column<int64_t>("missing"), std::invalid_argument);
+}
+
+void test_row_get() {
+    dpp_utils::result res = make_result(
+        {{"flag", BOOLOID}, {"id", INT8OID}},
+        {{"t", "565197576026980365"}, {"f", std::nullopt}});
+
+    CHECK(res[0].get<bool>(0));
+    CHECK(!res[1].get<bool>("flag"));
+    CHECK(res[0].get<int64_t>("id") == 565197576026980365);
+    CHECK(std::holds_alternative<std::monostate>(res[1].get(1)));
+}
+
+void test_parallel_column() {
+    // Enough rows for several chunks, with a count that isn't a multiple
+    // of 64 so the last chunk ends inside a bitmap word
+    constexpr int row_count = 100003;
+
+    std::vector<std::vector<cell>> rows;
+    rows.reserve(row_count);
+    for (int i = 0; i < row_count; ++i) {
+        if (i % 7 == 0) {
+            rows.push_back({std::nullopt, std::nullopt});
+        } else {
+            rows.push_back({std::to_string(i), "user_" + std::to_string(i)});
+        }
+    }
+
+    dpp_utils::result res =
+        make_result({{"id", INT8OID}, {"name", TEXTOID}}, rows);
+
+    const auto [ids, names] = res.columns<int64_t, std::string>();
+    const auto [parallel_ids, parallel_names] =
+        res.columns<int64_t, std::string>(true);
+
+    CHECK(parallel_ids.values == ids.values);
+    CHECK(parallel_ids.null_bitmap == ids.null_bitmap);
+    CHECK(parallel_names.values == names.values);
+    CHECK(parallel_names.null_bitmap == names.null_bitmap);
+    CHECK(ids.is_null(row_count - 1) && !ids.is_null(row_count - 2));
+}
+
+} // namespace
+
+int main() {
+    test_column_nulls();
+    test_column_types();
+    test_column_errors();
+    test_row_get();
+    test_parallel_column();
+
+    return TEST_RESULT();
+}
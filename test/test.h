@@ -0,0 +1,36 @@
+#pragma once
+
+#include <iostream>
+
+namespace dpp_utils::test {
+
+inline int failures = 0;
+
+} // namespace dpp_utils::test
+
+#define CHECK(expr)                                                            \
+    do {                                                                       \
+        if (!(expr)) {                                                         \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": CHECK(" #expr       \
+                      << ") failed\n";                                         \
+            ++dpp_utils::test::failures;                                       \
+        }                                                                      \
+    } while (false)
+
+#define CHECK_THROWS(expr, exception)                                          \
+    do {                                                                       \
+        bool thrown = false;                                                   \
+        try {                                                                  \
+            (void)(expr);                                                      \
+        } catch (const exception &) {                                          \
+            thrown = true;                                                     \
+        }                                                                      \
+                                                                               \
+        if (!thrown) {                                                         \
+            std::cerr << __FILE__ << ':' << __LINE__                           \
+                      << ": " #expr " didn't throw " #exception "\n";          \
+            ++dpp_utils::test::failures;                                       \
+        }                                                                      \
+    } while (false)
+
+#define TEST_RESULT() (dpp_utils::test::failures == 0 ? 0 : 1)